@@ -0,0 +1,330 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace bench
+{
+
+// Add an argument to the benchmark.
+Benchmark&
+Benchmark::arg(std::int64_t n)
+{
+  args.push_back(n);
+  return *this;
+}
+
+
+// Add the powers of 8 from `lo` up to `hi`, and `hi` itself,
+// as arguments to the benchmark.
+Benchmark&
+Benchmark::range(std::int64_t lo, std::int64_t hi)
+{
+  for (std::int64_t n = lo; n < hi; n *= 8)
+    args.push_back(n);
+  args.push_back(hi);
+  return *this;
+}
+
+
+namespace
+{
+
+// The registered benchmarks. These are owned by pointer so
+// that references returned by registration remain valid.
+std::vector<std::unique_ptr<Benchmark>>&
+benchmarks()
+{
+  static std::vector<std::unique_ptr<Benchmark>> v;
+  return v;
+}
+
+
+// Options controlling the benchmark runner.
+struct Options
+{
+  Options()
+    : format("console"), min_time(0.5), counters(false)
+  { }
+
+  std::string filter;   // Only run benchmarks containing this
+  std::string format;   // Output format (console or json)
+  std::string out;      // Also write JSON results to this file
+  double      min_time; // Minimum seconds per benchmark
+  bool        counters; // Read hardware counters
+};
+
+
+int
+usage()
+{
+  std::cerr << "usage: lingo_bench [--filter=<str>] [--format=console|json] "
+               "[--out=<file>] [--min-time=<seconds>] [--counters]\n";
+  return -1;
+}
+
+
+// Run the benchmark enough times that the measurement takes
+// at least the minimum time. The iteration count grows by the
+// predicted ratio, but by no more than a factor of 10.
+Result
+run(Benchmark const& b, std::string const& name, std::int64_t arg,
+    Options const& opts, lingo::Perf_counters const* ctrs)
+{
+  std::size_t n = 1;
+  while (true) {
+    State s(n, arg, ctrs);
+    b.fn(s);
+    double t = s.real_time();
+    if (t >= opts.min_time || n >= 1000000000) {
+      Result r;
+      r.name = name;
+      r.iterations = n;
+      r.real_time = t * 1e9 / n;
+      r.cpu_time = s.cpu_time() * 1e9 / n;
+      r.bytes_per_second = t > 0 ? s.bytes_processed() / t : 0;
+      r.items_per_second = t > 0 ? s.items_processed() / t : 0;
+      r.bytes = double(s.bytes_processed()) / n;
+      r.items = double(s.items_processed()) / n;
+      for (int i = 0; i < lingo::perf_event_count; ++i)
+        r.counts[i] = double(s.counts()[i]) / n;
+      return r;
+    }
+    double m = t > 0 ? opts.min_time * 1.4 / t : 10;
+    n = std::max<std::size_t>(n + 1, n * std::min(m, 10.0));
+  }
+}
+
+
+// Returns a human-readable rate such as "12.3 MB/s".
+std::string
+rate(double r, char const* unit)
+{
+  char const* units[] = {"", "k", "M", "G", "T"};
+  int u = 0;
+  while (r >= 1000 && u < 4) {
+    r /= 1000;
+    ++u;
+  }
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.3g %s%s/s", r, units[u], unit);
+  return buf;
+}
+
+
+void
+print_header(std::ostream& os)
+{
+  os << std::left << std::setw(40) << "benchmark"
+     << std::right << std::setw(14) << "time (ns)"
+     << std::setw(14) << "cpu (ns)"
+     << std::setw(14) << "iterations"
+     << "  throughput\n";
+  os << std::string(98, '-') << '\n';
+}
+
+
+void
+print_result(std::ostream& os, Result const& r)
+{
+  os << std::left << std::setw(40) << r.name
+     << std::right << std::fixed << std::setprecision(1)
+     << std::setw(14) << r.real_time
+     << std::setw(14) << r.cpu_time
+     << std::setw(14) << r.iterations;
+  if (r.bytes_per_second)
+    os << "  " << rate(r.bytes_per_second, "B");
+  if (r.items_per_second)
+    os << "  " << rate(r.items_per_second, "items");
+  os << '\n';
+}
+
+
+// Print the counts per `n` units.
+void
+print_counts(std::ostream& os, Result const& r, double n, char const* unit)
+{
+  os << std::setw(40) << "" << std::setprecision(3);
+  for (int i = 0; i < lingo::perf_event_count; ++i) {
+    os << "  " << r.counts[i] / n << ' '
+       << lingo::get_perf_event_name(lingo::Perf_event(i)) << '/' << unit;
+  }
+  os << '\n';
+}
+
+
+// Print the instructions per cycle, and the counts per byte
+// and per item when those are set, or otherwise per iteration.
+void
+print_counts(std::ostream& os, Result const& r)
+{
+  if (!r.counts[lingo::cycles_event])
+    return;
+  os << std::setw(40) << "" << std::fixed << std::setprecision(2)
+     << "  " << r.counts[lingo::instructions_event] / r.counts[lingo::cycles_event]
+     << " IPC\n";
+  if (r.bytes)
+    print_counts(os, r, r.bytes, "B");
+  if (r.items)
+    print_counts(os, r, r.items, "item");
+  if (!r.bytes && !r.items)
+    print_counts(os, r, 1, "iter");
+}
+
+
+// Write a JSON string literal.
+void
+print_string(std::ostream& os, std::string const& s)
+{
+  os << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      os << '\\';
+    os << c;
+  }
+  os << '"';
+}
+
+
+// Write the results in the JSON format used by Google
+// Benchmark so that existing tools can compare runs.
+void
+print_json(std::ostream& os, std::vector<Result> const& rs)
+{
+  std::time_t now = std::time(nullptr);
+  char date[64];
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+  os << "{\n";
+  os << "  \"context\": {\n";
+  os << "    \"date\": \"" << date << "\",\n";
+  os << "    \"num_cpus\": " << std::thread::hardware_concurrency() << "\n";
+  os << "  },\n";
+  os << "  \"benchmarks\": [";
+  for (std::size_t i = 0; i < rs.size(); ++i) {
+    Result const& r = rs[i];
+    os << (i ? ",\n" : "\n");
+    os << "    {\n";
+    os << "      \"name\": ";
+    print_string(os, r.name);
+    os << ",\n";
+    os << "      \"iterations\": " << r.iterations << ",\n";
+    os << std::setprecision(6) << std::defaultfloat;
+    os << "      \"real_time\": " << r.real_time << ",\n";
+    os << "      \"cpu_time\": " << r.cpu_time << ",\n";
+    os << "      \"time_unit\": \"ns\"";
+    if (r.bytes_per_second)
+      os << ",\n      \"bytes_per_second\": " << r.bytes_per_second;
+    if (r.items_per_second)
+      os << ",\n      \"items_per_second\": " << r.items_per_second;
+    if (r.counts[lingo::cycles_event]) {
+      for (int k = 0; k < lingo::perf_event_count; ++k) {
+        os << ",\n      \"" << lingo::get_perf_event_name(lingo::Perf_event(k))
+           << "\": " << r.counts[k];
+      }
+      os << ",\n      \"IPC\": "
+         << r.counts[lingo::instructions_event] / r.counts[lingo::cycles_event];
+    }
+    os << "\n    }";
+  }
+  os << "\n  ]\n";
+  os << "}\n";
+}
+
+
+} // namespace
+
+
+// Register a new benchmark.
+Benchmark&
+register_benchmark(char const* name, Function fn)
+{
+  benchmarks().emplace_back(new Benchmark(name, fn));
+  return *benchmarks().back();
+}
+
+
+// Run the registered benchmarks as directed by the command
+// line options and print their results.
+int
+run_benchmarks(int argc, char* argv[])
+{
+  Options opts;
+  for (int i = 1; i < argc; ++i) {
+    char const* arg = argv[i];
+    if (std::strncmp(arg, "--filter=", 9) == 0)
+      opts.filter = arg + 9;
+    else if (std::strncmp(arg, "--format=", 9) == 0)
+      opts.format = arg + 9;
+    else if (std::strncmp(arg, "--out=", 6) == 0)
+      opts.out = arg + 6;
+    else if (std::strncmp(arg, "--min-time=", 11) == 0)
+      opts.min_time = std::atof(arg + 11);
+    else if (std::strcmp(arg, "--counters") == 0)
+      opts.counters = true;
+    else
+      return usage();
+  }
+  if (opts.format != "console" && opts.format != "json")
+    return usage();
+
+  // Counters are created once, before any benchmark runs,
+  // and count events of the calling thread only.
+  std::unique_ptr<lingo::Perf_counters> ctrs;
+  if (opts.counters) {
+    ctrs.reset(new lingo::Perf_counters());
+    if (!ctrs->available()) {
+      std::cerr << "warning: hardware counters are not available\n";
+      ctrs.reset();
+    }
+  }
+
+  bool console = opts.format == "console";
+  if (console)
+    print_header(std::cout);
+
+  std::vector<Result> results;
+  for (auto const& b : benchmarks()) {
+    std::vector<std::int64_t> args = b->args;
+    bool named = !args.empty();
+    if (!named)
+      args.push_back(0);
+    for (std::int64_t a : args) {
+      std::string name = b->name;
+      if (named)
+        name += '/' + std::to_string(a);
+      if (name.find(opts.filter) == std::string::npos)
+        continue;
+      results.push_back(run(*b, name, a, opts, ctrs.get()));
+      if (console) {
+        print_result(std::cout, results.back());
+        print_counts(std::cout, results.back());
+      }
+    }
+  }
+
+  if (!console)
+    print_json(std::cout, results);
+  if (!opts.out.empty()) {
+    std::ofstream f(opts.out);
+    if (!f) {
+      std::cerr << "error: cannot open '" << opts.out << "'\n";
+      return 1;
+    }
+    print_json(f, results);
+  }
+  return 0;
+}
+
+
+} // namespace bench
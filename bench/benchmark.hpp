@@ -0,0 +1,235 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_BENCH_BENCHMARK_HPP
+#define LINGO_BENCH_BENCHMARK_HPP
+
+// The benchmark module is a small harness for measuring the
+// performance of lingo facilities. It is modeled on Google
+// Benchmark. A benchmark is a function that repeats the code
+// being measured for as long as its state requests:
+//
+//    void
+//    bench_thing(bench::State& state)
+//    {
+//      Thing t(state.arg());
+//      while (state.keep_running())
+//        bench::do_not_optimize(t.work());
+//      state.set_items_processed(state.iterations());
+//    }
+//    LINGO_BENCHMARK(bench_thing).arg(64).arg(4096);
+//
+// The harness chooses the number of iterations so that each
+// run takes at least a minimum amount of time, and reports
+// the time per iteration and, when set, the throughput of
+// each benchmark. Results can be written as JSON for tracking
+// performance regressions.
+//
+// When hardware counters are requested, the harness also reads
+// the processor's performance counters around the timed part
+// of each run, and reports instructions per cycle and the rates
+// of branch and cache misses per byte or item processed.
+
+#include <lingo/perf.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+// -------------------------------------------------------------------------- //
+//                            Benchmark state
+
+// The state of a single run of a benchmark. The state counts
+// iterations and measures the time taken by them.
+class State
+{
+  using Clock = std::chrono::steady_clock;
+
+public:
+  State(std::size_t n, std::int64_t a, lingo::Perf_counters const* c = nullptr)
+    : arg_(a), iters_(n), count_(0), running_(false),
+      real_(0), cpu_(0), bytes_(0), items_(0), ctrs_(c), counts_()
+  { }
+
+  bool keep_running();
+
+  void pause_timing();
+  void resume_timing();
+
+  // Returns the argument of the benchmark, or 0 if the
+  // benchmark has no arguments.
+  std::int64_t arg() const { return arg_; }
+
+  // Returns the number of iterations in this run.
+  std::size_t iterations() const { return iters_; }
+
+  // Set the number of bytes or items processed by the run.
+  // These determine the reported throughput.
+  void set_bytes_processed(std::int64_t n) { bytes_ = n; }
+  void set_items_processed(std::int64_t n) { items_ = n; }
+
+  // Returns the elapsed real and processor time in seconds.
+  double real_time() const { return real_; }
+  double cpu_time() const  { return cpu_; }
+
+  std::int64_t bytes_processed() const { return bytes_; }
+  std::int64_t items_processed() const { return items_; }
+
+  // Returns the hardware counts of the timed iterations. These
+  // are zero if counters were not requested.
+  lingo::Perf_sample const& counts() const { return counts_; }
+
+private:
+  std::int64_t      arg_;
+  std::size_t       iters_;
+  std::size_t       count_;
+  bool              running_;
+  Clock::time_point real_start_;
+  std::clock_t      cpu_start_;
+  double            real_;
+  double            cpu_;
+  std::int64_t      bytes_;
+  std::int64_t      items_;
+
+  lingo::Perf_counters const* ctrs_;
+  lingo::Perf_sample          start_counts_;
+  lingo::Perf_sample          counts_;
+};
+
+
+// Returns true while iterations remain. Timing starts on the
+// first call and stops when the last iteration is complete.
+inline bool
+State::keep_running()
+{
+  if (count_ == 0)
+    resume_timing();
+  if (count_ < iters_) {
+    ++count_;
+    return true;
+  }
+  pause_timing();
+  return false;
+}
+
+
+// Stop the timer. Use this to exclude setup work performed
+// within the benchmark loop from the measurement.
+inline void
+State::pause_timing()
+{
+  if (!running_)
+    return;
+  real_ += std::chrono::duration<double>(Clock::now() - real_start_).count();
+  cpu_ += double(std::clock() - cpu_start_) / CLOCKS_PER_SEC;
+  if (ctrs_)
+    counts_ += ctrs_->read() - start_counts_;
+  running_ = false;
+}
+
+
+// Restart the timer.
+inline void
+State::resume_timing()
+{
+  if (running_)
+    return;
+  running_ = true;
+  if (ctrs_)
+    start_counts_ = ctrs_->read();
+  cpu_start_ = std::clock();
+  real_start_ = Clock::now();
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Optimization barriers
+
+// Prevent the compiler from discarding the computation of
+// `x` as dead code.
+template<typename T>
+inline void
+do_not_optimize(T const& x)
+{
+  asm volatile("" : : "r,m"(x) : "memory");
+}
+
+
+// Prevent the compiler from eliding or reordering writes to
+// memory across this point.
+inline void
+clobber_memory()
+{
+  asm volatile("" : : : "memory");
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Registration
+
+using Function = void (*)(State&);
+
+
+// A registered benchmark. A benchmark with arguments is run
+// once for each argument, and its name is suffixed with the
+// argument.
+struct Benchmark
+{
+  Benchmark(char const* n, Function f)
+    : name(n), fn(f)
+  { }
+
+  Benchmark& arg(std::int64_t);
+  Benchmark& range(std::int64_t, std::int64_t);
+
+  std::string               name;
+  Function                  fn;
+  std::vector<std::int64_t> args;
+};
+
+
+Benchmark& register_benchmark(char const*, Function);
+
+
+#define LINGO_BENCHMARK_CONCAT_(a, b) a ## b
+#define LINGO_BENCHMARK_CONCAT(a, b) LINGO_BENCHMARK_CONCAT_(a, b)
+
+// Register the function `fn` as a benchmark. The result is a
+// Benchmark object, so arguments can be supplied by chaining.
+#define LINGO_BENCHMARK(fn) \
+  static ::bench::Benchmark& LINGO_BENCHMARK_CONCAT(benchmark_, __LINE__) \
+    __attribute__((unused)) = ::bench::register_benchmark(#fn, fn)
+
+
+// -------------------------------------------------------------------------- //
+//                            Running benchmarks
+
+// The measurements of a single benchmark run. Times are in
+// nanoseconds per iteration. Rates are per second, and are
+// zero when not set by the benchmark. Counts are per iteration,
+// and are zero when counters were not requested.
+struct Result
+{
+  std::string name;
+  std::size_t iterations;
+  double      real_time;
+  double      cpu_time;
+  double      bytes_per_second;
+  double      items_per_second;
+  double      bytes;
+  double      items;
+  double      counts[lingo::perf_event_count];
+};
+
+
+int run_benchmarks(int, char*[]);
+
+
+} // namespace bench
+
+#endif
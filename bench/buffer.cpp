@@ -0,0 +1,65 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "benchmark.hpp"
+#include "generator.hpp"
+
+#include "lingo/buffer.hpp"
+
+#include <random>
+
+using namespace lingo;
+
+
+namespace
+{
+
+// Returns about `n` bytes of generated stlc source code.
+String
+make_text(std::size_t n)
+{
+  bench::Corpus_options opts;
+  opts.size = n;
+  return bench::generate_corpus(opts);
+}
+
+
+} // namespace
+
+
+// Construct a buffer, which builds its line map.
+void
+buffer_construction(bench::State& state)
+{
+  String text = make_text(state.arg());
+  while (state.keep_running()) {
+    Buffer buf(text);
+    bench::do_not_optimize(buf.lines().size());
+  }
+  state.set_bytes_processed(state.iterations() * text.size());
+}
+LINGO_BENCHMARK(buffer_construction).range(1 << 10, 1 << 20);
+
+
+// Resolve character offsets to line and column numbers.
+void
+line_map_locus(bench::State& state)
+{
+  String text = make_text(state.arg());
+  Buffer buf(text);
+  std::minstd_rand gen(42);
+  std::uniform_int_distribution<int> off(0, text.size() - 1);
+  std::vector<int> offsets(1024);
+  for (int& n : offsets)
+    n = off(gen);
+
+  std::size_t i = 0;
+  while (state.keep_running()) {
+    Locus loc = buf.lines().locus(offsets[i++ % offsets.size()]);
+    bench::do_not_optimize(loc);
+  }
+  state.set_items_processed(state.iterations());
+}
+LINGO_BENCHMARK(line_map_locus).range(1 << 10, 1 << 20);
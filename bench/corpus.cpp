@@ -0,0 +1,75 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+// The corpus program writes a synthetic program to a file
+// or to standard output (see generator.hpp).
+
+#include "generator.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using namespace bench;
+
+
+int
+usage()
+{
+  std::cerr << "usage: lingo_corpus [--lang=calc|lambda|stlc] [--seed=<n>] "
+               "[--size=<n>[K|M|G]] [--depth=<n>] [--vocabulary=<n>] "
+               "[--skew=<x>] [--error-rate=<x>] [--out=<file>]\n";
+  return -1;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  Corpus_options opts;
+  char const* out = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    char const* arg = argv[i];
+    if (std::strncmp(arg, "--lang=", 7) == 0) {
+      if (!parse_language(arg + 7, opts.lang))
+        return usage();
+    } else if (std::strncmp(arg, "--size=", 7) == 0) {
+      if (!parse_size(arg + 7, opts.size))
+        return usage();
+    } else if (std::strncmp(arg, "--seed=", 7) == 0) {
+      opts.seed = std::strtoull(arg + 7, nullptr, 10);
+    } else if (std::strncmp(arg, "--depth=", 8) == 0) {
+      opts.depth = std::atoi(arg + 8);
+    } else if (std::strncmp(arg, "--vocabulary=", 13) == 0) {
+      opts.vocabulary = std::atoi(arg + 13);
+    } else if (std::strncmp(arg, "--skew=", 7) == 0) {
+      opts.skew = std::atof(arg + 7);
+    } else if (std::strncmp(arg, "--error-rate=", 13) == 0) {
+      opts.error_rate = std::atof(arg + 13);
+    } else if (std::strncmp(arg, "--out=", 6) == 0) {
+      out = arg + 6;
+    } else {
+      return usage();
+    }
+  }
+  if (opts.depth < 0 || opts.vocabulary <= 0 || opts.skew < 0)
+    return usage();
+
+  Corpus_stats stats;
+  if (out) {
+    std::ofstream f(out);
+    if (!f) {
+      std::cerr << "error: cannot open '" << out << "'\n";
+      return 1;
+    }
+    stats = generate_corpus(f, opts);
+  } else {
+    stats = generate_corpus(std::cout, opts);
+  }
+
+  std::cerr << "corpus: " << stats.bytes << " bytes, "
+            << stats.statements << " statements, "
+            << stats.errors << " errors\n";
+  return 0;
+}
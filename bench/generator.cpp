@@ -0,0 +1,454 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "generator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace bench
+{
+
+namespace
+{
+
+// -------------------------------------------------------------------------- //
+//                            Random numbers
+
+// A pseudo-random number generator (splitmix64). Unlike the
+// standard engines and distributions, its results do not
+// depend on the library implementation.
+class Random
+{
+public:
+  explicit Random(std::uint64_t s)
+    : state_(s)
+  { }
+
+  std::uint64_t next()
+  {
+    std::uint64_t z = (state_ += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+
+  // Returns a value in [0, n).
+  std::uint64_t uniform(std::uint64_t n) { return next() % n; }
+
+  // Returns a value in [0, 1).
+  double real() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+  // Returns true with probability p.
+  bool chance(double p) { return real() < p; }
+
+private:
+  std::uint64_t state_;
+};
+
+
+// A Zipf distribution over [0, n) with exponent s. Samples
+// are drawn by searching the cumulative distribution.
+class Zipf
+{
+public:
+  Zipf(int n, double s)
+    : cdf_(n)
+  {
+    double sum = 0;
+    for (int i = 0; i < n; ++i)
+      cdf_[i] = sum += 1 / std::pow(i + 1, s);
+    for (double& x : cdf_)
+      x /= sum;
+  }
+
+  int operator()(Random& r) const
+  {
+    auto iter = std::upper_bound(cdf_.begin(), cdf_.end(), r.real());
+    return std::min<int>(iter - cdf_.begin(), cdf_.size() - 1);
+  }
+
+private:
+  std::vector<double> cdf_;
+};
+
+
+// Returns an identifier spelling the number `n` with lowercase
+// letters, following the prefix `p`. Identifiers with different
+// prefixes are distinct.
+std::string
+identifier(char p, std::uint64_t n)
+{
+  std::string s(1, p);
+  do {
+    s += char('a' + n % 26);
+    n /= 26;
+  } while (n);
+  return s;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Generator
+
+// A generated term and the syntactic category of its text.
+struct Term
+{
+  std::string text;
+  bool        primary; // An identifier or parenthesized term
+  bool        abs;     // An abstraction
+};
+
+
+// A variable and its type.
+struct Binding
+{
+  std::string name;
+  int         type;
+};
+
+
+// A type is either a base type or an arrow type. Types are
+// interned, so they are the same when their indexes are.
+struct Type_rep
+{
+  int in;  // The parameter type, or -1 for base types
+  int out; // The result type, or the base type number
+};
+
+
+// The number of base types in typed programs.
+constexpr int base_types = 4;
+
+// The number of recent definitions that can be referenced.
+constexpr std::size_t window = 64;
+
+
+class Generator
+{
+public:
+  Generator(std::ostream&, Corpus_options const&);
+
+  Corpus_stats run();
+
+private:
+  void        emit(std::string const&);
+  std::string calc_statement(bool);
+  std::string calc_expr(int);
+  std::string lambda_statement(bool);
+  Term        term(int, int);
+  Term        abs(int, int);
+  Term        app(int, int);
+  Term        var(int);
+
+  int         arrow(int, int);
+  int         random_type(int);
+  std::string spell(int);
+
+  std::ostream&                      os_;
+  Corpus_options                     opts_;
+  Random                             rand_;
+  Zipf                               names_;
+  bool                               typed_;
+  Corpus_stats                       stats_;
+  std::vector<Type_rep>              types_;
+  std::map<std::pair<int, int>, int> arrows_;
+  std::vector<Binding>               scope_;
+  std::deque<Binding>                defs_;
+};
+
+
+Generator::Generator(std::ostream& os, Corpus_options const& o)
+  : os_(os), opts_(o), rand_(o.seed), names_(std::max(o.vocabulary, 1), o.skew),
+    typed_(o.lang == stlc_lang), stats_()
+{
+  for (int i = 0; i < base_types; ++i)
+    types_.push_back({-1, i});
+}
+
+
+Corpus_stats
+Generator::run()
+{
+  // Typed programs declare a constant of each base type.
+  if (opts_.lang == stlc_lang) {
+    for (int i = 0; i < base_types; ++i)
+      emit(identifier('c', i) + " : " + spell(i) + ";\n");
+  }
+
+  while (stats_.bytes < opts_.size) {
+    bool err = rand_.chance(opts_.error_rate);
+    if (opts_.lang == calc_lang)
+      emit(calc_statement(err));
+    else
+      emit(lambda_statement(err));
+    ++stats_.statements;
+    if (err)
+      ++stats_.errors;
+  }
+  return stats_;
+}
+
+
+void
+Generator::emit(std::string const& s)
+{
+  os_ << s;
+  stats_.bytes += s.size();
+}
+
+
+// A calc statement is a line containing an expression. An
+// error leaves a dangling operator.
+std::string
+Generator::calc_statement(bool err)
+{
+  std::string s = calc_expr(opts_.depth);
+  if (err)
+    s += " +";
+  return s + '\n';
+}
+
+
+std::string
+Generator::calc_expr(int d)
+{
+  if (d <= 0 || rand_.chance(0.2)) {
+    std::string lit = std::to_string(rand_.uniform(10000));
+    return rand_.chance(0.1) ? '-' + lit : lit;
+  }
+
+  static char const* ops[] = {" + ", " - ", " * ", " / "};
+  int op = rand_.uniform(4);
+  std::string l = calc_expr(d - 1);
+  std::string r = op == 3 ? std::to_string(1 + rand_.uniform(99)) : calc_expr(d - 1);
+  if (rand_.chance(0.5))
+    l = '(' + l + ')';
+  if (rand_.chance(0.5))
+    r = '(' + r + ')';
+  return l + ops[op] + r;
+}
+
+
+// A statement is either a definition or an expression of
+// base type, whose value is printed. Errors are a stray
+// parenthesis, or in typed programs, a reference to an
+// undeclared name or an ill-typed application.
+//
+// The evaluators do not evaluate definitions, so each
+// definition binds an abstraction.
+std::string
+Generator::lambda_statement(bool err)
+{
+  std::string s;
+  int t = -1;
+  bool def = rand_.chance(0.75);
+  if (def) {
+    s = identifier('d', stats_.statements) + " = ";
+    t = arrow(random_type(1), random_type(1));
+  } else {
+    t = rand_.uniform(base_types);
+  }
+
+  int kind = err ? (typed_ ? rand_.uniform(3) : 0) : -1;
+  if (kind == 1)
+    s += identifier('u', rand_.uniform(1000));
+  else if (kind == 2)
+    s += identifier('c', 0) + ' ' + identifier('c', 1);
+  else if (def)
+    s += abs(t, opts_.depth).text;
+  else
+    s += term(t, opts_.depth).text;
+  if (kind == 0)
+    s += " )";
+
+  if (def && !err) {
+    defs_.push_back({identifier('d', stats_.statements), t});
+    if (defs_.size() > window)
+      defs_.pop_front();
+  }
+  return s + ";\n";
+}
+
+
+// Generate a term of type `t` with nesting depth at most `d`,
+// except that abstractions are always available at arrow type.
+Term
+Generator::term(int t, int d)
+{
+  bool arrow = types_[t].in >= 0;
+  if (d <= 0 || rand_.chance(0.3)) {
+    Term v = var(t);
+    if (!v.text.empty())
+      return v;
+    if (arrow)
+      return abs(t, d);
+    return {identifier('c', types_[t].out), true, false};
+  }
+  if (arrow && rand_.chance(0.5))
+    return abs(t, d);
+  return app(t, d);
+}
+
+
+// Generate an abstraction of arrow type `t`. The name of the
+// variable is drawn from the vocabulary.
+Term
+Generator::abs(int t, int d)
+{
+  Type_rep r = types_[t];
+  Binding b {identifier('v', names_(rand_)), r.in};
+  std::string s = "\\" + b.name;
+  if (typed_)
+    s += ':' + spell(r.in);
+  s += '.';
+  scope_.push_back(b);
+  s += term(r.out, d - 1).text;
+  scope_.pop_back();
+  return {s, false, true};
+}
+
+
+// Generate an application whose result has type `t`.
+Term
+Generator::app(int t, int d)
+{
+  int a = random_type(1);
+  Term f = term(arrow(a, t), d - 1);
+  Term x = term(a, d - 1);
+  std::string s = f.abs ? '(' + f.text + ')' : f.text;
+  s += ' ';
+  s += x.primary ? x.text : '(' + x.text + ')';
+  return {s, false, false};
+}
+
+
+// Returns a reference to a visible variable of type `t`,
+// preferring the innermost binding, or an empty term if there
+// is no such variable.
+Term
+Generator::var(int t)
+{
+  std::vector<std::string const*> vs;
+  std::vector<std::string const*> seen;
+  for (auto iter = scope_.rbegin(); iter != scope_.rend(); ++iter) {
+    auto shadow = std::find_if(seen.begin(), seen.end(), [&](std::string const* s) {
+      return *s == iter->name;
+    });
+    if (shadow != seen.end())
+      continue;
+    seen.push_back(&iter->name);
+    if (iter->type == t)
+      vs.push_back(&iter->name);
+  }
+  for (Binding const& b : defs_) {
+    if (b.type == t)
+      vs.push_back(&b.name);
+  }
+  if (vs.empty())
+    return {};
+  std::size_t n = rand_.chance(0.5) ? 0 : rand_.uniform(vs.size());
+  return {*vs[n], true, false};
+}
+
+
+// Returns the arrow type `a -> b`.
+int
+Generator::arrow(int a, int b)
+{
+  auto ins = arrows_.emplace(std::make_pair(a, b), types_.size());
+  if (ins.second)
+    types_.push_back({a, b});
+  return ins.first->second;
+}
+
+
+// Returns a random type with at most `d` nested arrows.
+int
+Generator::random_type(int d)
+{
+  if (d <= 0 || rand_.chance(0.5))
+    return rand_.uniform(base_types);
+  return arrow(random_type(d - 1), random_type(d - 1));
+}
+
+
+// Returns the spelling of type `t`. Arrows are right
+// associative.
+std::string
+Generator::spell(int t)
+{
+  Type_rep r = types_[t];
+  if (r.in < 0)
+    return std::string(1, 'A' + r.out);
+  std::string in = spell(r.in);
+  if (types_[r.in].in >= 0)
+    in = '(' + in + ')';
+  return in + "->" + spell(r.out);
+}
+
+
+} // namespace
+
+
+// Write a corpus to the output stream.
+Corpus_stats
+generate_corpus(std::ostream& os, Corpus_options const& opts)
+{
+  Generator gen(os, opts);
+  return gen.run();
+}
+
+
+// Returns a corpus as a string.
+std::string
+generate_corpus(Corpus_options const& opts)
+{
+  std::ostringstream ss;
+  generate_corpus(ss, opts);
+  return ss.str();
+}
+
+
+// Parse the name of a corpus language.
+bool
+parse_language(char const* s, Corpus_language& lang)
+{
+  if (std::strcmp(s, "calc") == 0)
+    lang = calc_lang;
+  else if (std::strcmp(s, "lambda") == 0)
+    lang = lambda_lang;
+  else if (std::strcmp(s, "stlc") == 0)
+    lang = stlc_lang;
+  else
+    return false;
+  return true;
+}
+
+
+// Parse a size in bytes with an optional binary suffix (K,
+// M, or G).
+bool
+parse_size(char const* s, std::uint64_t& n)
+{
+  char* end;
+  n = std::strtoull(s, &end, 10);
+  if (end == s)
+    return false;
+  switch (*end) {
+    case 'K': n <<= 10; ++end; break;
+    case 'M': n <<= 20; ++end; break;
+    case 'G': n <<= 30; ++end; break;
+    default: break;
+  }
+  return *end == 0;
+}
+
+
+} // namespace bench
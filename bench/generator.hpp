@@ -0,0 +1,81 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_BENCH_GENERATOR_HPP
+#define LINGO_BENCH_GENERATOR_HPP
+
+// The generator module produces synthetic programs in the
+// languages of the examples (calc, lambda, and stlc) for load
+// testing their lexers, parsers, and evaluators.
+//
+// Generation is deterministic: the same options and seed
+// produce the same text on every platform. Programs are
+// written incrementally, so corpora may be much larger than
+// available memory.
+//
+// Without errors, the generated programs are valid. Programs
+// in stlc are well-typed, and programs in lambda are well-typed
+// stlc programs with their types erased, so their evaluation
+// always terminates. Programs in calc never divide by a zero
+// literal.
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace bench
+{
+
+enum Corpus_language
+{
+  calc_lang,
+  lambda_lang,
+  stlc_lang
+};
+
+
+// Options controlling the generated corpus.
+//
+// The size is approximate: generation stops after the first
+// statement that reaches it. The vocabulary is the number of
+// distinct identifiers used for bound variables, which are
+// drawn with a Zipf distribution whose exponent is the skew.
+// A skew of 0 draws identifiers uniformly. The error rate is
+// the fraction of statements containing a syntax, name, or
+// type error.
+struct Corpus_options
+{
+  Corpus_options()
+    : lang(stlc_lang), seed(1), size(1 << 20), depth(6),
+      vocabulary(1000), skew(1.0), error_rate(0)
+  { }
+
+  Corpus_language lang;
+  std::uint64_t   seed;
+  std::uint64_t   size;
+  int             depth;
+  int             vocabulary;
+  double          skew;
+  double          error_rate;
+};
+
+
+// Counts of what was generated.
+struct Corpus_stats
+{
+  std::uint64_t bytes;
+  std::uint64_t statements;
+  std::uint64_t errors;
+};
+
+
+Corpus_stats generate_corpus(std::ostream&, Corpus_options const&);
+std::string  generate_corpus(Corpus_options const&);
+
+bool parse_language(char const*, Corpus_language&);
+bool parse_size(char const*, std::uint64_t&);
+
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,145 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "benchmark.hpp"
+#include "generator.hpp"
+
+#include "lingo/buffer.hpp"
+#include "lingo/character.hpp"
+#include "lingo/symbol.hpp"
+#include "lingo/token.hpp"
+
+using namespace lingo;
+
+
+namespace
+{
+
+enum Token_kind
+{
+  symbol_tok,
+  identifier_tok,
+  integer_tok
+};
+
+
+// A lexer for the stlc language, written in the style of the
+// examples' lexers.
+struct Lexer
+{
+  Lexer(Symbol_table& s, Character_stream& cs, Token_stream& ts)
+    : syms_(s), cs_(cs), ts_(ts)
+  { }
+
+  void operator()()
+  {
+    while (Token tok = scan())
+      ts_.put(tok);
+  }
+
+  Token scan();
+  Token symbol();
+  Token identifier();
+  Token integer();
+
+  Symbol_table&     syms_;
+  Character_stream& cs_;
+  Token_stream&     ts_;
+  String_builder    str_;
+  Location          loc_;
+};
+
+
+Token
+Lexer::scan()
+{
+  while (!cs_.eof()) {
+    while (is_space(cs_.peek()))
+      cs_.ignore();
+
+    loc_ = cs_.location();
+    switch (cs_.peek()) {
+    case '\0': return Token{};
+    case '(':
+    case ')':
+    case '\\':
+    case '.':
+    case '=':
+    case ':':
+    case ';':
+      return symbol();
+
+    case '-':
+      str_.put(cs_.get());
+      return symbol();
+
+    default:
+      if (is_alpha(cs_.peek()))
+        return identifier();
+      if (is_decimal_digit(cs_.peek()))
+        return integer();
+      cs_.ignore();
+    }
+  }
+  return Token{};
+}
+
+
+Token
+Lexer::symbol()
+{
+  str_.put(cs_.get());
+  return Token(loc_, syms_.get(str_.take()));
+}
+
+
+Token
+Lexer::identifier()
+{
+  while (is_alpha(cs_.peek()))
+    str_.put(cs_.get());
+  return Token(loc_, syms_.put_identifier(identifier_tok, str_.take()));
+}
+
+
+Token
+Lexer::integer()
+{
+  while (is_decimal_digit(cs_.peek()))
+    str_.put(cs_.get());
+  String s = str_.take();
+  return Token(loc_, syms_.put_integer(integer_tok, s, string_to_int<int>(s, 10)));
+}
+
+
+} // namespace
+
+
+// Lex about `arg` bytes of generated stlc source code. The
+// items processed are tokens.
+void
+lexing(bench::State& state)
+{
+  bench::Corpus_options opts;
+  opts.size = state.arg();
+  String text = bench::generate_corpus(opts);
+  Buffer buf(text);
+
+  Symbol_table syms;
+  for (char const* s : {"(", ")", "\\", ".", "=", ":", ";", "->"})
+    syms.put_symbol(symbol_tok, s);
+
+  std::size_t tokens = 0;
+  while (state.keep_running()) {
+    Character_stream cs(buf);
+    Token_stream ts(buf);
+    Lexer lex(syms, cs, ts);
+    lex();
+    tokens += ts.buf_.size();
+  }
+  state.set_bytes_processed(state.iterations() * text.size());
+  state.set_items_processed(tokens);
+}
+LINGO_BENCHMARK(lexing).range(1 << 10, 1 << 20);
@@ -0,0 +1,11 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "benchmark.hpp"
+
+int main(int argc, char* argv[])
+{
+  return bench::run_benchmarks(argc, argv);
+}
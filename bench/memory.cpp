@@ -0,0 +1,78 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "benchmark.hpp"
+
+#include "lingo/memory.hpp"
+
+using namespace lingo;
+
+
+namespace
+{
+
+// A nullary node.
+struct Leaf
+{
+  virtual ~Leaf() { }
+};
+
+
+// A binary node. Note that marking does not check for null
+// pointers, so each pair has two leaves.
+struct Pair
+{
+  Pair(Leaf const* a, Leaf const* b)
+    : first(a), second(b)
+  { }
+
+  virtual ~Pair() { }
+
+  Leaf const* first;
+  Leaf const* second;
+};
+
+
+// Allocate `n` pairs and their leaves, declaring each pair
+// reachable from `r`.
+void
+make_pairs(int n, Reach& r)
+{
+  for (int i = 0; i < n; ++i)
+    r(gc().make<Pair>(gc().make<Leaf>(), gc().make<Leaf>()));
+}
+
+
+// Allocate `n` pairs and their leaves, none of which are
+// reachable.
+void
+make_garbage(int n)
+{
+  for (int i = 0; i < n; ++i)
+    gc().make<Pair>(gc().make<Leaf>(), gc().make<Leaf>());
+}
+
+
+} // namespace
+
+
+// Collect a heap in which half of the objects are reachable.
+// Allocation is not measured.
+void
+collecting_factory_collect(bench::State& state)
+{
+  int n = state.arg() / 6;
+  while (state.keep_running()) {
+    state.pause_timing();
+    Reach root;
+    make_pairs(n, root);
+    make_garbage(n);
+    state.resume_timing();
+    gc().collect();
+  }
+  gc().collect();
+  state.set_items_processed(state.iterations() * n * 6);
+}
+LINGO_BENCHMARK(collecting_factory_collect).range(1 << 6, 1 << 15);
@@ -0,0 +1,353 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "pipeline.hpp"
+
+#include "lingo/accounting.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <streambuf>
+
+namespace bench
+{
+
+// Add `t` seconds to the time of the phase `name` in the
+// current repetition.
+void
+Pipeline::record(char const* name, double t)
+{
+  std::size_t i = 0;
+  while (i != result_.phases.size() && result_.phases[i].name != name)
+    ++i;
+  if (i == result_.phases.size()) {
+    result_.phases.push_back({name, std::numeric_limits<double>::infinity()});
+    times_.push_back(0);
+  }
+  times_[i] += t;
+}
+
+
+// Keep the fastest time of each phase.
+void
+Pipeline::finish_repetition()
+{
+  for (std::size_t i = 0; i < times_.size(); ++i) {
+    result_.phases[i].seconds = std::min(result_.phases[i].seconds, times_[i]);
+    times_[i] = 0;
+  }
+}
+
+
+namespace
+{
+
+// Options controlling the driver.
+struct Options
+{
+  Options()
+    : repeat(3), threshold(10)
+  { }
+
+  Corpus_options corpus;
+  std::string    input;     // Use this corpus instead of generating one
+  std::string    out;       // Write JSON results to this file
+  std::string    baseline;  // Compare with the results in this file
+  int            repeat;    // Number of repetitions
+  double         threshold; // Allowed regression, in percent
+};
+
+
+int
+usage(char const* prog)
+{
+  std::cerr << "usage: " << prog << " [--size=<n>[K|M|G]] [--seed=<n>] "
+               "[--corpus=<file>] [--repeat=<n>] [--out=<file>] "
+               "[--baseline=<file> [--threshold=<percent>]]\n";
+  return -1;
+}
+
+
+// A stream buffer that discards its output.
+struct Null_buffer : std::streambuf
+{
+  int overflow(int c) override { return c; }
+};
+
+
+// Returns the number of lingo allocations so far.
+std::size_t
+count_allocations()
+{
+  std::size_t n = 0;
+  for (int i = 0; i < lingo::memory_subsystem_count; ++i)
+    n += lingo::get_memory_usage(lingo::Memory_subsystem(i)).allocations;
+  return n;
+}
+
+
+// Returns the peak resident set size of the process in bytes.
+std::size_t
+peak_rss()
+{
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(__APPLE__)
+  return usage.ru_maxrss;
+#else
+  return usage.ru_maxrss * 1024;
+#endif
+}
+
+
+char const*
+get_language_name(Corpus_language lang)
+{
+  switch (lang) {
+    case calc_lang: return "calc";
+    case lambda_lang: return "lambda";
+    case stlc_lang: return "stlc";
+  }
+  return "<unknown>";
+}
+
+
+// Returns the total time of all phases.
+double
+total_time(Pipeline_result const& r)
+{
+  double t = 0;
+  for (Phase_result const& p : r.phases)
+    t += p.seconds;
+  return t;
+}
+
+
+void
+print_phase(std::ostream& os, Pipeline_result const& r, char const* name, double t)
+{
+  os << std::left << std::setw(12) << name
+     << std::right << std::fixed
+     << std::setw(14) << std::setprecision(3) << t * 1e3
+     << std::setw(12) << std::setprecision(2) << r.bytes / t / 1e6
+     << std::setw(14) << std::setprecision(3) << r.tokens / t / 1e6 << '\n';
+}
+
+
+void
+print_result(std::ostream& os, Pipeline_result const& r)
+{
+  os << r.lang << ": " << r.bytes << " bytes, " << r.tokens << " tokens, "
+     << "peak RSS " << std::fixed << std::setprecision(1) << r.peak_rss / 1e6 << " MB, "
+     << r.allocations << " allocations\n";
+  os << std::left << std::setw(12) << "phase"
+     << std::right << std::setw(14) << "time (ms)"
+     << std::setw(12) << "MB/s"
+     << std::setw(14) << "Mtokens/s" << '\n';
+  os << std::string(52, '-') << '\n';
+  for (Phase_result const& p : r.phases)
+    print_phase(os, r, p.name.c_str(), p.seconds);
+  print_phase(os, r, "total", total_time(r));
+}
+
+
+void
+print_json_phase(std::ostream& os, Pipeline_result const& r, std::string const& name, double t)
+{
+  os << "    {\n";
+  os << "      \"name\": \"" << name << "\",\n";
+  os << "      \"seconds\": " << t << ",\n";
+  os << "      \"bytes_per_second\": " << r.bytes / t << ",\n";
+  os << "      \"tokens_per_second\": " << r.tokens / t << "\n";
+  os << "    }";
+}
+
+
+void
+print_json(std::ostream& os, Pipeline_result const& r)
+{
+  os << std::setprecision(6) << std::defaultfloat;
+  os << "{\n";
+  os << "  \"language\": \"" << r.lang << "\",\n";
+  os << "  \"bytes\": " << r.bytes << ",\n";
+  os << "  \"tokens\": " << r.tokens << ",\n";
+  os << "  \"peak_rss\": " << r.peak_rss << ",\n";
+  os << "  \"allocations\": " << r.allocations << ",\n";
+  os << "  \"phases\": [\n";
+  for (Phase_result const& p : r.phases) {
+    print_json_phase(os, r, p.name, p.seconds);
+    os << ",\n";
+  }
+  print_json_phase(os, r, "total", total_time(r));
+  os << "\n  ]\n";
+  os << "}\n";
+}
+
+
+// Returns the throughput in bytes per second of the phase
+// `name` in JSON results written by print_json(), or 0 if the
+// phase is not found.
+double
+find_throughput(std::string const& json, std::string const& name)
+{
+  std::size_t n = json.find("\"name\": \"" + name + "\"");
+  if (n == std::string::npos)
+    return 0;
+  char const* key = "\"bytes_per_second\":";
+  n = json.find(key, n);
+  if (n == std::string::npos)
+    return 0;
+  return std::strtod(json.c_str() + n + std::strlen(key), nullptr);
+}
+
+
+// Compare the results with the baseline. Returns false if any
+// phase, or the total, regressed by more than the threshold.
+bool
+compare(std::ostream& os, Pipeline_result const& r, std::string const& json, double threshold)
+{
+  std::vector<Phase_result> phases = r.phases;
+  phases.push_back({"total", total_time(r)});
+
+  bool ok = true;
+  os << "\ncomparison with baseline (threshold "
+     << std::defaultfloat << std::setprecision(6) << threshold << "%)\n";
+  for (Phase_result const& p : phases) {
+    double base = find_throughput(json, p.name);
+    if (base == 0) {
+      os << std::left << std::setw(12) << p.name << "  not in baseline\n";
+      continue;
+    }
+    double cur = r.bytes / p.seconds;
+    double change = (cur - base) / base * 100;
+    bool regressed = change < -threshold;
+    os << std::left << std::setw(12) << p.name
+       << std::right << std::fixed << std::setprecision(1)
+       << std::setw(10) << change << '%'
+       << (regressed ? "  REGRESSION" : "") << '\n';
+    ok &= !regressed;
+  }
+  return ok;
+}
+
+
+} // namespace
+
+
+// Run the pipeline as directed by the command line options,
+// and report its results. Returns 0 on success, 1 if an
+// error occurred or the pipeline regressed.
+int
+run_pipeline(int argc, char* argv[], Corpus_language lang, Translation fn)
+{
+  Options opts;
+  opts.corpus.lang = lang;
+  for (int i = 1; i < argc; ++i) {
+    char const* arg = argv[i];
+    if (std::strncmp(arg, "--size=", 7) == 0) {
+      if (!parse_size(arg + 7, opts.corpus.size))
+        return usage(argv[0]);
+    } else if (std::strncmp(arg, "--seed=", 7) == 0) {
+      opts.corpus.seed = std::strtoull(arg + 7, nullptr, 10);
+    } else if (std::strncmp(arg, "--corpus=", 9) == 0) {
+      opts.input = arg + 9;
+    } else if (std::strncmp(arg, "--repeat=", 9) == 0) {
+      opts.repeat = std::atoi(arg + 9);
+    } else if (std::strncmp(arg, "--out=", 6) == 0) {
+      opts.out = arg + 6;
+    } else if (std::strncmp(arg, "--baseline=", 11) == 0) {
+      opts.baseline = arg + 11;
+    } else if (std::strncmp(arg, "--threshold=", 12) == 0) {
+      opts.threshold = std::atof(arg + 12);
+    } else {
+      return usage(argv[0]);
+    }
+  }
+  if (opts.repeat <= 0 || opts.threshold < 0)
+    return usage(argv[0]);
+
+  // Read the baseline first so that a missing file is
+  // reported before running.
+  std::string baseline;
+  if (!opts.baseline.empty()) {
+    std::ifstream f(opts.baseline);
+    if (!f) {
+      std::cerr << "error: cannot open '" << opts.baseline << "'\n";
+      return 1;
+    }
+    std::stringstream ss;
+    ss << f.rdbuf();
+    baseline = ss.str();
+  }
+
+  // Write the corpus to a temporary file so that loading it
+  // is part of the pipeline.
+  boost::filesystem::path path = opts.input;
+  bool temp = path.empty();
+  if (temp) {
+    path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    std::ofstream f(path.native());
+    generate_corpus(f, opts.corpus);
+    if (!f) {
+      std::cerr << "error: cannot write '" << path.native() << "'\n";
+      return 1;
+    }
+  }
+
+  Pipeline_result result {get_language_name(lang), 0, 0, 0, 0, {}};
+  result.bytes = boost::filesystem::file_size(path);
+  Pipeline pipe(result);
+
+  // Discard the output of the translation. Translations throw
+  // exceptions when the corpus is ill-formed.
+  Null_buffer null;
+  std::streambuf* out = std::cout.rdbuf(&null);
+  bool ok = true;
+  try {
+    for (int i = 0; i < opts.repeat; ++i) {
+      std::size_t allocs = count_allocations();
+      fn(pipe, path.c_str());
+      pipe.finish_repetition();
+      result.allocations = count_allocations() - allocs;
+    }
+  } catch (std::exception& err) {
+    std::cerr << "error: " << err.what() << '\n';
+    ok = false;
+  }
+  std::cout.rdbuf(out);
+  result.peak_rss = peak_rss();
+
+  if (temp)
+    boost::filesystem::remove(path);
+  if (!ok)
+    return 1;
+
+  print_result(std::cout, result);
+  if (!opts.out.empty()) {
+    std::ofstream f(opts.out);
+    if (!f) {
+      std::cerr << "error: cannot open '" << opts.out << "'\n";
+      return 1;
+    }
+    print_json(f, result);
+  }
+  if (!baseline.empty() && !compare(std::cout, result, baseline, opts.threshold))
+    return 1;
+  return 0;
+}
+
+
+} // namespace bench
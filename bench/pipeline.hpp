@@ -0,0 +1,114 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_BENCH_PIPELINE_HPP
+#define LINGO_BENCH_PIPELINE_HPP
+
+// The pipeline module measures the end-to-end throughput of
+// a language implementation. Each example provides a driver
+// that runs its phases (load, lex, parse, and evaluate) over a
+// generated corpus:
+//
+//    void
+//    translate(bench::Pipeline& p, char const* path)
+//    {
+//      File* input;
+//      p.phase("load", [&]() { input = new File(path); });
+//      ...
+//    }
+//
+//    int
+//    main(int argc, char* argv[])
+//    {
+//      return bench::run_pipeline(argc, argv, bench::stlc_lang, translate);
+//    }
+//
+// The pipeline is repeated and the fastest time of each phase
+// is reported along with its throughput in bytes and tokens per
+// second, the peak resident set size of the process, and the
+// number of allocations made by lingo. Results can be saved as
+// JSON and compared with a saved baseline, in which case the
+// driver fails if any phase is slower than the baseline by more
+// than a threshold.
+
+#include "generator.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+
+// The measurement of a single phase. The time is the fastest
+// of all repetitions, in seconds.
+struct Phase_result
+{
+  std::string name;
+  double      seconds;
+};
+
+
+// The measurements of a pipeline.
+struct Pipeline_result
+{
+  std::string               lang;
+  std::uint64_t             bytes;
+  std::uint64_t             tokens;
+  std::size_t               peak_rss;    // In bytes
+  std::size_t               allocations; // Per repetition
+  std::vector<Phase_result> phases;
+};
+
+
+// A pipeline records the time spent in each phase of a single
+// repetition of the translation.
+class Pipeline
+{
+  using Clock = std::chrono::steady_clock;
+
+public:
+  explicit Pipeline(Pipeline_result& r)
+    : result_(r)
+  { }
+
+  template<typename F>
+  void phase(char const*, F);
+
+  // Set the number of tokens in the corpus.
+  void set_tokens(std::uint64_t n) { result_.tokens = n; }
+
+  void finish_repetition();
+
+private:
+  void record(char const*, double);
+
+  Pipeline_result&    result_;
+  std::vector<double> times_; // Times of the current repetition
+};
+
+
+// Run `f` as the phase `name`. When a phase runs several times
+// within a repetition (e.g., once per line), its times are
+// summed.
+template<typename F>
+inline void
+Pipeline::phase(char const* name, F f)
+{
+  Clock::time_point start = Clock::now();
+  f();
+  Clock::time_point stop = Clock::now();
+  record(name, std::chrono::duration<double>(stop - start).count());
+}
+
+
+using Translation = std::function<void(Pipeline&, char const*)>;
+
+int run_pipeline(int, char*[], Corpus_language, Translation);
+
+
+} // namespace bench
+
+#endif
@@ -0,0 +1,38 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "benchmark.hpp"
+
+#include "lingo/print.hpp"
+
+#include <sstream>
+
+using namespace lingo;
+
+
+// Print a sequence of indented lines, each containing
+// words and values.
+void
+printer_output(bench::State& state)
+{
+  std::stringstream ss;
+  std::int64_t bytes = 0;
+  while (state.keep_running()) {
+    ss.str(String());
+    Printer p(ss);
+    indent(p);
+    for (int i = 0; i < state.arg(); ++i) {
+      print(p, "value");
+      print_space(p);
+      print_value(p, std::intmax_t(i));
+      print_space(p);
+      print_value(p, i * 0.5);
+      print_newline(p);
+    }
+    bytes += ss.tellp();
+  }
+  state.set_bytes_processed(bytes);
+}
+LINGO_BENCHMARK(printer_output).range(1 << 6, 1 << 12);
@@ -0,0 +1,57 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "benchmark.hpp"
+
+#include "lingo/string.hpp"
+
+#include <random>
+
+using namespace lingo;
+
+
+namespace
+{
+
+// Returns integer literals in base `b` that fit in an int.
+std::vector<String>
+make_literals(int b)
+{
+  std::minstd_rand gen(42);
+  std::uniform_int_distribution<int> val(0, 1 << 30);
+  char const* digits = "0123456789abcdef";
+  std::vector<String> v;
+  for (int i = 0; i < 1024; ++i) {
+    int n = val(gen);
+    String s;
+    do {
+      s.insert(s.begin(), digits[n % b]);
+      n /= b;
+    } while (n);
+    v.push_back(s);
+  }
+  return v;
+}
+
+
+} // namespace
+
+
+// Convert integer literals in the base given by the argument.
+void
+string_to_int(bench::State& state)
+{
+  std::vector<String> lits = make_literals(state.arg());
+  std::int64_t bytes = 0;
+  std::size_t i = 0;
+  while (state.keep_running()) {
+    String const& s = lits[i++ % lits.size()];
+    bench::do_not_optimize(lingo::string_to_int<int>(s, state.arg()));
+    bytes += s.size();
+  }
+  state.set_bytes_processed(bytes);
+  state.set_items_processed(state.iterations());
+}
+LINGO_BENCHMARK(string_to_int).arg(2).arg(10).arg(16);
@@ -0,0 +1,71 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "benchmark.hpp"
+
+#include "lingo/symbol.hpp"
+
+#include <random>
+
+using namespace lingo;
+
+
+namespace
+{
+
+constexpr int identifier_tok = 1;
+
+
+// Returns `n` distinct identifiers of varying length.
+std::vector<String>
+make_identifiers(std::size_t n)
+{
+  std::minstd_rand gen(42);
+  std::uniform_int_distribution<int> len(1, 12);
+  std::uniform_int_distribution<int> chr('a', 'z');
+  std::vector<String> ids;
+  for (std::size_t i = 0; i < n; ++i) {
+    String s = std::to_string(i);
+    for (int k = len(gen); k; --k)
+      s += char(chr(gen));
+    ids.push_back(s);
+  }
+  return ids;
+}
+
+
+} // namespace
+
+
+// Insert distinct identifiers into an empty table.
+void
+symbol_table_put(bench::State& state)
+{
+  std::vector<String> ids = make_identifiers(state.arg());
+  while (state.keep_running()) {
+    Symbol_table syms;
+    for (String const& s : ids)
+      bench::do_not_optimize(syms.put_identifier(identifier_tok, s));
+  }
+  state.set_items_processed(state.iterations() * ids.size());
+}
+LINGO_BENCHMARK(symbol_table_put).range(1 << 6, 1 << 15);
+
+
+// Look up identifiers in a populated table.
+void
+symbol_table_get(bench::State& state)
+{
+  std::vector<String> ids = make_identifiers(state.arg());
+  Symbol_table syms;
+  for (String const& s : ids)
+    syms.put_identifier(identifier_tok, s);
+
+  std::size_t i = 0;
+  while (state.keep_running())
+    bench::do_not_optimize(syms.get(ids[i++ % ids.size()]));
+  state.set_items_processed(state.iterations());
+}
+LINGO_BENCHMARK(symbol_table_get).range(1 << 6, 1 << 15);
@@ -0,0 +1,63 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "benchmark.hpp"
+
+#include "lingo/buffer.hpp"
+#include "lingo/token.hpp"
+
+using namespace lingo;
+
+
+namespace
+{
+
+constexpr int identifier_tok = 1;
+
+
+} // namespace
+
+
+// Append tokens to an empty stream.
+void
+token_stream_put(bench::State& state)
+{
+  Buffer buf(String(state.arg(), 'x'));
+  Symbol_table syms;
+  Symbol const* sym = syms.put_identifier(identifier_tok, "x");
+  while (state.keep_running()) {
+    Token_stream ts(buf);
+    for (int i = 0; i < state.arg(); ++i)
+      ts.put(Token(Location(&buf, i), sym));
+    bench::do_not_optimize(ts.buf_.size());
+  }
+  state.set_items_processed(state.iterations() * state.arg());
+}
+LINGO_BENCHMARK(token_stream_put).range(1 << 6, 1 << 15);
+
+
+// Consume a stream of tokens with one token of lookahead,
+// as a parser does.
+void
+token_stream_peek(bench::State& state)
+{
+  Buffer buf(String(state.arg(), 'x'));
+  Symbol_table syms;
+  Symbol const* sym = syms.put_identifier(identifier_tok, "x");
+  Token_stream ts(buf);
+  for (int i = 0; i < state.arg(); ++i)
+    ts.put(Token(Location(&buf, i), sym));
+
+  while (state.keep_running()) {
+    ts.reposition(ts.buf_.begin());
+    while (!ts.eof()) {
+      bench::do_not_optimize(ts.peek().kind());
+      bench::do_not_optimize(ts.peek(1).kind());
+      ts.get();
+    }
+  }
+  state.set_items_processed(state.iterations() * state.arg());
+}
+LINGO_BENCHMARK(token_stream_peek).range(1 << 6, 1 << 15);
@@ -0,0 +1,59 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "benchmark.hpp"
+
+#include "lingo/unicode.hpp"
+
+using namespace lingo;
+
+
+namespace
+{
+
+// Returns `n` bytes of UTF-8 text mixing one, two, and three
+// byte characters.
+std::string
+make_text(std::size_t n)
+{
+  std::string sample = u8"Tôi có thể ăn thủy tinh mà không hại gì. ";
+  std::string s;
+  while (s.size() + sample.size() <= n)
+    s += sample;
+  return s;
+}
+
+
+} // namespace
+
+
+// Convert UTF-8 text to UTF-16.
+void
+convert_utf8_to_utf16(bench::State& state)
+{
+  std::string text = make_text(state.arg());
+  Character_set_converter conv("UTF-8", "UTF-16LE");
+  while (state.keep_running()) {
+    conv.reset();
+    bench::do_not_optimize(conv.convert<char16_t>(text));
+  }
+  state.set_bytes_processed(state.iterations() * text.size());
+}
+LINGO_BENCHMARK(convert_utf8_to_utf16).range(1 << 10, 1 << 16);
+
+
+// Convert UTF-8 text to UTF-32.
+void
+convert_utf8_to_utf32(bench::State& state)
+{
+  std::string text = make_text(state.arg());
+  Character_set_converter conv("UTF-8", "UTF-32LE");
+  while (state.keep_running()) {
+    conv.reset();
+    bench::do_not_optimize(conv.convert<char32_t>(text));
+  }
+  state.set_bytes_processed(state.iterations() * text.size());
+}
+LINGO_BENCHMARK(convert_utf8_to_utf32).range(1 << 10, 1 << 16);
@@ -96,6 +96,63 @@ evaluate(Expr const* e)
 }
 
 
+// -------------------------------------------------------------------------- //
+//                                  Flat trees
+
+// Returns an empty flat tree for expressions. The names of
+// its kinds are those of the corresponding node classes, so
+// that flat and linked trees have the same debug output.
+Flat_tree
+make_flat_tree()
+{
+  return Flat_tree({
+    type_str(typeid(Int)),
+    type_str(typeid(Add)),
+    type_str(typeid(Sub)),
+    type_str(typeid(Mul)),
+    type_str(typeid(Div)),
+    type_str(typeid(Mod)),
+    type_str(typeid(Neg)),
+    type_str(typeid(Pos))
+  });
+}
+
+
+// Add the nodes of `e` to the flat tree `t`, returning the
+// index of its root.
+int
+flatten(Flat_tree& t, Expr const* e)
+{
+  struct Fn
+  {
+    Flat_tree& t;
+
+    int unary(Expr_kind k, Unary const* e)
+    {
+      int a = flatten(t, e->arg());
+      return t.make(k, e->location(), {a});
+    }
+
+    int binary(Expr_kind k, Binary const* e)
+    {
+      int a = flatten(t, e->left());
+      int b = flatten(t, e->right());
+      return t.make(k, e->location(), {a, b});
+    }
+
+    int operator()(Int const* e) { return t.make(int_expr, e->location()); }
+    int operator()(Add const* e) { return binary(add_expr, e); }
+    int operator()(Sub const* e) { return binary(sub_expr, e); }
+    int operator()(Mul const* e) { return binary(mul_expr, e); }
+    int operator()(Div const* e) { return binary(div_expr, e); }
+    int operator()(Mod const* e) { return binary(mod_expr, e); }
+    int operator()(Neg const* e) { return unary(neg_expr, e); }
+    int operator()(Pos const* e) { return unary(pos_expr, e); }
+  };
+  return apply(e, Fn{t});
+}
+
+
 // -------------------------------------------------------------------------- //
 //                                  Printing
 
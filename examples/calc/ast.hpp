@@ -9,6 +9,7 @@
 #include <lingo/token.hpp>
 #include <lingo/print.hpp>
 #include <lingo/debug.hpp>
+#include <lingo/flat.hpp>
 
 namespace calc
 {
@@ -246,6 +247,28 @@ apply(Expr const* e, F fn)
 Integer evaluate(Expr const*);
 
 
+// -------------------------------------------------------------------------- //
+//                                Flat trees
+
+// The kinds of expressions in a flat tree (see lingo/flat.hpp).
+enum Expr_kind
+{
+  int_expr,
+  add_expr,
+  sub_expr,
+  mul_expr,
+  div_expr,
+  mod_expr,
+  neg_expr,
+  pos_expr,
+  expr_kind_count
+};
+
+
+Flat_tree make_flat_tree();
+int       flatten(Flat_tree&, Expr const*);
+
+
 // -------------------------------------------------------------------------- //
 //                                  Facilities
 
@@ -259,7 +282,7 @@ std::ostream& operator<<(std::ostream&, Expr const&);
 
 
 // Debug printing
-void debug(std::ostream&, Expr const*);
+void debug(Printer&, Expr const*);
 
 
 } // namespace calc
@@ -0,0 +1,203 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+// Compares the parsing throughput of the calc parser, which
+// parses binary expressions by precedence climbing over an
+// operator table, with that of a parser that has one rule for
+// each precedence level, on a generated corpus.
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "ast.hpp"
+
+#include <lingo/combinator.hpp>
+#include <lingo/error.hpp>
+#include <lingo/io.hpp>
+
+#include <bench/generator.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+
+using namespace lingo;
+using namespace calc;
+
+
+// Initialize the token set used by the language.
+void
+init_tokens()
+{
+  symbols.put_symbol(lparen_tok, "(");
+  symbols.put_symbol(rparen_tok, ")");
+  symbols.put_symbol(plus_tok, "+");
+  symbols.put_symbol(minus_tok, "-");
+  symbols.put_symbol(star_tok, "*");
+  symbols.put_symbol(slash_tok, "/");
+}
+
+
+// A parser with a rule for each precedence level. Each binary
+// operator is found by comparing the next token with each of
+// the operators of each level.
+struct Level_parser
+{
+  Level_parser(Token_stream&);
+
+  Expr const* operator()();
+
+  Token_stream&     ts_;
+  Rule<Expr const*> primary;
+  Rule<Expr const*> unary;
+  Rule<Expr const*> multiplicative;
+  Rule<Expr const*> additive;
+};
+
+
+Expr const*
+make_int(Token tok)
+{
+  return new Int(tok.location(), tok.integer_symbol()->value());
+}
+
+
+Expr const*
+make_paren(Token, Expr const* e, Token)
+{
+  return e;
+}
+
+
+Expr const*
+make_unary(Token tok, Expr const* e)
+{
+  if (tok.kind() == plus_tok)
+    return new Pos(tok.location(), e);
+  return new Neg(tok.location(), e);
+}
+
+
+Expr const*
+make_binary(Token tok, Expr const* e1, Expr const* e2)
+{
+  Location loc = tok.location();
+  switch (tok.kind()) {
+    case plus_tok: return new Add(loc, e1, e2);
+    case minus_tok: return new Sub(loc, e1, e2);
+    case star_tok: return new Mul(loc, e1, e2);
+    case slash_tok: return new Div(loc, e1, e2);
+    case percent_tok: return new Mod(loc, e1, e2);
+    default: break;
+  }
+  lingo_unreachable("invalid binary operator '{}'", tok.spelling());
+}
+
+
+Level_parser::Level_parser(Token_stream& ts)
+  : ts_(ts)
+{
+  primary = alt(sequence(make_int, tok(integer_tok)),
+                sequence(make_paren, tok(lparen_tok), additive, tok(rparen_tok)));
+  unary = alt(sequence(make_unary, one_of(plus_tok, minus_tok), unary),
+              primary);
+  multiplicative = chain_left(unary, one_of(star_tok, slash_tok, percent_tok), make_binary);
+  additive = chain_left(multiplicative, one_of(plus_tok, minus_tok), make_binary);
+}
+
+
+Expr const*
+Level_parser::operator()()
+{
+  Parse_state s(ts_);
+  Expr const* e = additive(s);
+  s.commit();
+  return e;
+}
+
+
+// Returns the time, in seconds, taken to parse each of the token
+// streams with a parser of type P.
+template<typename P>
+double
+measure(std::vector<std::unique_ptr<Token_stream>> const& streams)
+{
+  using Clock = std::chrono::steady_clock;
+  for (auto const& ts : streams)
+    ts->reposition(ts->buf_.begin());
+  Clock::time_point start = Clock::now();
+  for (auto const& ts : streams) {
+    P parse(*ts);
+    if (!is_valid_node(parse()) || !ts->eof())
+      throw std::runtime_error("syntax errors in corpus");
+  }
+  Clock::time_point stop = Clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  init_colors();
+  init_tokens();
+
+  bench::Corpus_options opts;
+  opts.lang = bench::calc_lang;
+  opts.size = 1 << 20;
+  int repeat = 5;
+  if (argc > 1 && !bench::parse_size(argv[1], opts.size))
+    opts.size = 0;
+  if (argc > 2)
+    repeat = std::atoi(argv[2]);
+  if (opts.size == 0 || repeat <= 0) {
+    std::cerr << "usage: calc_bench [<size>[K|M|G] [<repetitions>]]\n";
+    return -1;
+  }
+
+  // Lex each line of the corpus.
+  std::vector<std::unique_ptr<Buffer>> lines;
+  std::vector<std::unique_ptr<Token_stream>> streams;
+  std::size_t tokens = 0;
+  String text = bench::generate_corpus(opts);
+  for (std::size_t i = 0, j; i < text.size(); i = j + 1) {
+    j = std::min(text.find('\n', i), text.size());
+    if (i == j)
+      continue;
+    lines.emplace_back(new Buffer(text.substr(i, j - i)));
+    Character_stream cs(*lines.back());
+    streams.emplace_back(new Token_stream(*lines.back()));
+    Lexer lex(cs, *streams.back());
+    lex();
+    tokens += streams.back()->buf_.size();
+  }
+  if (error_count()) {
+    std::cerr << "error: lexical errors in corpus\n";
+    return 1;
+  }
+
+  try {
+    // Alternate between the parsers, keeping the fastest time
+    // of each.
+    double levels = std::numeric_limits<double>::infinity();
+    double pratt = std::numeric_limits<double>::infinity();
+    for (int i = 0; i < repeat; ++i) {
+      levels = std::min(levels, measure<Level_parser>(streams));
+      pratt = std::min(pratt, measure<Parser>(streams));
+    }
+    std::cout << "tokens:        " << tokens << '\n';
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "levels:        " << tokens / levels / 1e6 << " Mtokens/s\n";
+    std::cout << "precedence:    " << tokens / pratt / 1e6 << " Mtokens/s\n";
+    std::cout << "speedup:       " << levels / pratt << "x\n";
+  } catch (std::exception& err) {
+    std::cerr << "error: " << err.what() << '\n';
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,189 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+// Compares the time taken to count the nodes of each kind in a
+// generated corpus when expressions are linked objects with that
+// taken when they are stored in a flat tree (see lingo/flat.hpp).
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "ast.hpp"
+
+#include <lingo/error.hpp>
+#include <lingo/io.hpp>
+
+#include <bench/generator.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+
+using namespace lingo;
+using namespace calc;
+
+
+using Counts = std::vector<std::size_t>;
+
+
+// Initialize the token set used by the language.
+void
+init_tokens()
+{
+  symbols.put_symbol(lparen_tok, "(");
+  symbols.put_symbol(rparen_tok, ")");
+  symbols.put_symbol(plus_tok, "+");
+  symbols.put_symbol(minus_tok, "-");
+  symbols.put_symbol(star_tok, "*");
+  symbols.put_symbol(slash_tok, "/");
+}
+
+
+// Count the nodes of each kind in the linked expression `e`.
+void
+count(Counts& n, Expr const* e)
+{
+  struct Fn
+  {
+    Counts& n;
+
+    void operator()(Int const*)   { ++n[int_expr]; }
+    void operator()(Add const* e) { ++n[add_expr]; binary(e); }
+    void operator()(Sub const* e) { ++n[sub_expr]; binary(e); }
+    void operator()(Mul const* e) { ++n[mul_expr]; binary(e); }
+    void operator()(Div const* e) { ++n[div_expr]; binary(e); }
+    void operator()(Mod const* e) { ++n[mod_expr]; binary(e); }
+    void operator()(Neg const* e) { ++n[neg_expr]; count(n, e->arg()); }
+    void operator()(Pos const* e) { ++n[pos_expr]; count(n, e->arg()); }
+
+    void binary(Binary const* e)
+    {
+      count(n, e->left());
+      count(n, e->right());
+    }
+  };
+  apply(e, Fn{n});
+}
+
+
+// Count the nodes of each kind in the flat tree `t`.
+void
+count(Counts& n, Flat_tree const& t)
+{
+  for (Flat_tree::Kind k : t.kinds())
+    ++n[k];
+}
+
+
+// Returns the time, in seconds, taken to run `f`.
+template<typename F>
+double
+measure(F f)
+{
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  f();
+  Clock::time_point stop = Clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+
+// Returns the debug output of `x`.
+template<typename T>
+String
+debug_string(T const& x)
+{
+  std::stringstream ss;
+  Printer p(ss);
+  debug(p, x);
+  return ss.str();
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  init_colors();
+  init_tokens();
+
+  bench::Corpus_options opts;
+  opts.lang = bench::calc_lang;
+  opts.size = 1 << 20;
+  int repeat = 5;
+  if (argc > 1 && !bench::parse_size(argv[1], opts.size))
+    opts.size = 0;
+  if (argc > 2)
+    repeat = std::atoi(argv[2]);
+  if (opts.size == 0 || repeat <= 0) {
+    std::cerr << "usage: calc_layout [<size>[K|M|G] [<repetitions>]]\n";
+    return -1;
+  }
+
+  // Parse each line of the corpus, and add its expression to
+  // the flat tree.
+  std::vector<Expr const*> exprs;
+  std::vector<int> roots;
+  Flat_tree tree = make_flat_tree();
+  String text = bench::generate_corpus(opts);
+  for (std::size_t i = 0, j; i < text.size(); i = j + 1) {
+    j = std::min(text.find('\n', i), text.size());
+    if (i == j)
+      continue;
+    Buffer buf(text.substr(i, j - i));
+    Character_stream cs(buf);
+    Token_stream ts(buf);
+    Lexer lex(cs, ts);
+    lex();
+    Parser parse(ts);
+    Expr const* e = parse();
+    if (error_count() || !is_valid_node(e)) {
+      std::cerr << "error: syntax errors in corpus\n";
+      return 1;
+    }
+    exprs.push_back(e);
+    roots.push_back(flatten(tree, e));
+  }
+
+  // Both layouts shall hold the same trees.
+  for (std::size_t i = 0; i < exprs.size(); i += 1 + exprs.size() / 64) {
+    if (debug_string(exprs[i]) != debug_string(tree[roots[i]])) {
+      std::cerr << "error: layouts differ for expression " << i << '\n';
+      return 1;
+    }
+  }
+
+  // Alternate between the layouts, keeping the fastest time
+  // of each.
+  Counts linked(expr_kind_count);
+  Counts flat(expr_kind_count);
+  double ptr = std::numeric_limits<double>::infinity();
+  double soa = std::numeric_limits<double>::infinity();
+  for (int i = 0; i < repeat; ++i) {
+    ptr = std::min(ptr, measure([&]() {
+      std::fill(linked.begin(), linked.end(), 0);
+      for (Expr const* e : exprs)
+        count(linked, e);
+    }));
+    soa = std::min(soa, measure([&]() {
+      std::fill(flat.begin(), flat.end(), 0);
+      count(flat, tree);
+    }));
+  }
+  if (linked != flat) {
+    std::cerr << "error: layouts have different counts\n";
+    return 1;
+  }
+
+  std::cout << "nodes:         " << tree.size() << '\n';
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "linked:        " << tree.size() / ptr / 1e6 << " Mnodes/s\n";
+  std::cout << "flat:          " << tree.size() / soa / 1e6 << " Mnodes/s\n";
+  std::cout << "speedup:       " << ptr / soa << "x\n";
+  return 0;
+}
@@ -4,6 +4,7 @@
 #include "lexer.hpp"
 
 #include "lingo/error.hpp"
+#include "lingo/trace.hpp"
 
 #include <cassert>
 #include <cctype>
@@ -151,6 +152,7 @@ Lexer::on_integer()
 void
 Lexer::operator()()
 {
+  lingo_trace_scope("lex");
   while (Token tok = scan())
     ts_.put(tok);
 }
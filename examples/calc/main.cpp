@@ -10,8 +10,11 @@
 #include "lingo/error.hpp"
 #include "lingo/memory.hpp"
 #include "lingo/io.hpp"
+#include "lingo/trace.hpp"
 
+#include <cstring>
 #include <iostream>
+#include <memory>
 
 
 using namespace lingo;
@@ -39,12 +42,36 @@ prompt(std::string& line)
 }
 
 
+// Print the program usage.
 int
-main()
+usage()
+{
+  std::cerr << "usage: calc [--trace[-counters]=<file>]\n";
+  return -1;
+}
+
+
+int
+main(int argc, char* argv[])
 {
   init_colors();
   init_tokens();
 
+  // The --trace option records the time spent in each phase
+  // and writes it to the given file in the Chrome trace event
+  // format when the session ends. The --trace-counters option
+  // also records hardware counters for each phase.
+  std::unique_ptr<Trace_file> trace;
+  for (int i = 1; i < argc; ++i) {
+    char const* arg = argv[i];
+    if (std::strncmp(arg, "--trace=", 8) == 0)
+      trace.reset(new Trace_file(arg + 8));
+    else if (std::strncmp(arg, "--trace-counters=", 17) == 0)
+      trace.reset(new Trace_file(arg + 17, true));
+    else
+      return usage();
+  }
+
   evaluation_mode(eval_mode);
   std::string line;
   while (prompt(line)) {
@@ -61,40 +88,41 @@ main()
       continue;
     }
 
-    try {
-      Character_stream cs(buf);
-      Token_stream ts(buf);
-      Lexer lex(cs, ts);
-      Parser parse(ts);
-
-      // Transform characters into tokens.
-      lex();
-      if (error_count()) {
-        reset_diagnostics();
-        continue;
-      }
-
-      // Transform tokens into abstract syntax.
-      Expr const* expr = parse();
-      if (error_count()) {
-        reset_diagnostics();
-        continue;
-      }
-
-      // This isn't an error. It's essentially an empty
-      // sequence of tokens.
-      if (!expr)
-        continue;
+    Character_stream cs(buf);
+    Token_stream ts(buf);
+    Lexer lex(cs, ts);
+    Parser parse(ts);
 
-      if (is_step_mode())
-        step_eval(expr);
-      else
-        std::cout << expr << " == " << evaluate(expr) << '\n';
+    // Transform characters into tokens.
+    lex();
+    if (error_count()) {
+      reset_diagnostics();
+      continue;
     }
-    catch (Parse_error& err) {
-      // Clear the diagnostic count and resume
-      // taking input and parsing.
+
+    // Transform tokens into abstract syntax. If the line is
+    // ill-formed, the errors have been diagnosed; clear the
+    // diagnostic count and resume taking input.
+    Expr const* expr = parse();
+    if (error_count()) {
       reset_diagnostics();
+      continue;
+    }
+
+    // This isn't an error. It's essentially an empty
+    // sequence of tokens.
+    if (!expr)
+      continue;
+
+    if (is_step_mode())
+      step_eval(expr);
+    else {
+      Integer n;
+      {
+        lingo_trace_scope("evaluate");
+        n = evaluate(expr);
+      }
+      std::cout << expr << " == " << n << '\n';
     }
   }
 }
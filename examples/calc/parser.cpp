@@ -6,6 +6,9 @@
 #include "ast.hpp"
 
 #include "lingo/error.hpp"
+#include "lingo/node.hpp"
+#include "lingo/pratt.hpp"
+#include "lingo/trace.hpp"
 
 #include <iostream>
 
@@ -16,196 +19,66 @@ namespace calc
 namespace
 {
 
-// Returns a spelling for the current token. If the token
-// stream is at the end of input, then the spelling will
-// reflect that state.
-String const&
-token_spelling(Token_stream& ts)
+// Returns the spelling of the token kind `k`.
+char const*
+spelling(int k)
 {
-  static String end = "end-of-file";
-  if (ts.eof())
-    return end;
-  else
-    return ts.peek().spelling();
-}
-
-} // namespace
-
-
-// Returns the first token of lookahead.
-Token_kind
-Parser::lookahead() const
-{
-  return Token_kind(ts_.peek().kind());
-}
-
-
-// Returns the nth token of lookahead.
-Token_kind
-Parser::lookahead(int n) const
-{
-  return Token_kind(ts_.peek(n).kind());
+  return get_spelling(Token_kind(k));
 }
 
 
-Token
-Parser::match(Token_kind k)
-{
-  if (lookahead() == k)
-    return ts_.get();
-
-  String msg = format("expected '{}' but got '{}'",
-                      get_spelling(k),
-                      token_spelling(ts_));
-  error(ts_.location(), msg);
-  throw Parse_error("match");
-}
-
-
-// If the current token matches k, return the token
-// and advance the stream. Otherwise, return an
-// invalid token.
-//
-// Note that invalid tokens evaluate to false.
-Token
-Parser::match_if(Token_kind k)
+// Returns a binary expression of type T.
+template<typename T>
+Expr const*
+make_binary(Token tok, Expr const* e1, Expr const* e2)
 {
-  if (lookahead() == k)
-    return ts_.get();
-  else
-    return Token();
+  return new T(tok.location(), e1, e2);
 }
 
 
-// Require a token of the given kind. Behavior is
-// udefined if the token does not match.
-Token
-Parser::require(Token_kind k)
-{
-  assert(lookahead() == k);
-  return ts_.get();
-}
-
+// The binary operators.
+constexpr Operator_table<Expr const*, integer_tok + 1> binary_ops {
+  {plus_tok,    10, left_assoc, make_binary<Add>},
+  {minus_tok,   10, left_assoc, make_binary<Sub>},
+  {star_tok,    20, left_assoc, make_binary<Mul>},
+  {slash_tok,   20, left_assoc, make_binary<Div>},
+  {percent_tok, 20, left_assoc, make_binary<Mod>},
+};
 
-// Returns the current token and advances the
-// underlying token stream.
-Token
-Parser::accept()
-{
-  return ts_.get();
-}
+} // namespace
 
 
 // -------------------------------------------------------------------------- //
-//                          Primary expressions
+//                            Grammar
 
-
-// Parse a paren-enclosed expression.
-//
-// FIXME: Improve diagnostics for matched parens.
-Expr const*
-Parser::paren()
-{
-  this->require(lparen_tok);
-  Expr const* e = expr();
-  match(rparen_tok);
-  return e;
-}
-
-
-// Parse a primary expression.
+// Define the grammar.
 //
 //    primary-expression ::=
 //        integer-literal
 //      | '(' expression ')'
-Expr const*
-Parser::primary()
-{
-  if (Token tok = match_if(integer_tok))
-    return on_int(tok);
-  if (lookahead() == lparen_tok)
-    return paren();
-  error(ts_.location(), "expected primary-expression");
-  throw Parse_error("primary");
-}
-
-
-// Parse a unary epxression. A unary expressions is one
-// that begins with an operator and is followed by a
-// unary expression.
 //
 //    unary-expression ::=
 //        primary-expression
-//      | unary-operator unary-expression.
-Expr const*
-Parser::unary()
-{
-  if (Token tok = match_if(plus_tok))
-    return on_unary(tok, unary());
-  if (Token tok = match_if(minus_tok))
-    return on_unary(tok, unary());
-  return primary();
-}
-
-
-// Parse a multiplicative expression.
+//      | unary-operator unary-expression
 //
-//    multiplicative-expression ::=
+//    expression ::=
 //        unary-expression
-//      | multiplicative-expression multiplicative-operator unary-expression
-Expr const*
-Parser::multiplicative()
-{
-  Expr const* e = unary();
-  while (true) {
-    if (Token tok = match_if(star_tok))
-      e = on_binary(tok, e, unary());
-    else if (Token tok = match_if(slash_tok))
-      e = on_binary(tok, e, unary());
-    else if (Token tok = match_if(percent_tok))
-      e = on_binary(tok, e, unary());
-    else
-      break;
-  }
-  return e;
-}
-
-
-// Parse an additive expression.
+//      | expression binary-operator expression
 //
-//    additive-expression ::=
-//        multiplicative-expression
-//      | additive-expression additive-operator multiplicative-expression
-Expr const*
-Parser::additive()
+// The precedence and associativity of binary operators are
+// given by the operator table.
+Parser::Parser(Token_stream& ts)
+  : ts_(ts), primary("primary-expression")
 {
-  Expr const* e = multiplicative();
-  while (true) {
-    if (Token tok = match_if(plus_tok))
-      e = on_binary(tok, e, multiplicative());
-    else if (Token tok = match_if(minus_tok))
-      e = on_binary(tok, e, multiplicative());
-    else
-      break;
-  }
-  return e;
-}
-
-
-// Parse a binary expression. This is the top-level entry point
-// for the binary precedence parser.
-inline Expr const*
-Parser::binary()
-{
-  return additive();
-}
-
+  auto int_ = [this](Token tok) { return on_int(tok); };
+  auto paren = [this](Token l, Expr const* e, Token r) { return on_paren(l, e, r); };
+  auto unary_ = [this](Token tok, Expr const* e) { return on_unary(tok, e); };
 
-// Parse an expression.
-Expr const*
-Parser::expr()
-{
-  return binary();
+  primary = alt(sequence(int_, tok(integer_tok)),
+                sequence(paren, tok(lparen_tok), expr, tok(rparen_tok)));
+  unary = alt(sequence(unary_, one_of(plus_tok, minus_tok), unary),
+              primary);
+  expr = precedence(unary, binary_ops);
 }
 
 
@@ -219,41 +92,41 @@ Parser::on_int(Token tok)
 }
 
 
+// FIXME: Improve diagnostics for matched parens.
 Expr const*
-Parser::on_unary(Token tok, Expr const* e)
+Parser::on_paren(Token, Expr const* e, Token)
 {
-  Location loc = tok.location();
-  switch (tok.kind()) {
-    case plus_tok: return new Pos(loc, e);
-    case minus_tok: return new Neg(loc, e);
-    default: break;
-  }
-  lingo_unreachable("invalid unary operator", tok.spelling());
+  return e;
 }
 
 
 Expr const*
-Parser::on_binary(Token tok, Expr const* e1, Expr const* e2)
+Parser::on_unary(Token tok, Expr const* e)
 {
   Location loc = tok.location();
   switch (tok.kind()) {
-    case plus_tok: return new Add(loc, e1, e2);
-    case minus_tok: return new Sub(loc, e1, e2);
-    case star_tok: return new Mul(loc, e1, e2);
-    case slash_tok: return new Div(loc, e1, e2);
-    case percent_tok: return new Mod(loc, e1, e2);
+    case plus_tok: return new Pos(loc, e);
+    case minus_tok: return new Neg(loc, e);
     default: break;
   }
-  lingo_unreachable("invalid binary operator '{}'", tok.spelling());
+  lingo_unreachable("invalid unary operator", tok.spelling());
 }
 
 
 Expr const*
 Parser::operator()()
 {
+  lingo_trace_scope("parse");
   if (ts_.eof())
     return nullptr;
-  return expr();
+  Parse_state s(ts_, spelling);
+  Expr const* e = expr(s);
+  if (!e || !s.eof()) {
+    s.diagnose();
+    return make_error_node<Expr>();
+  }
+  s.commit();
+  return e;
 }
 
 
@@ -6,6 +6,8 @@
 
 #include "lexer.hpp"
 
+#include <lingo/combinator.hpp>
+
 namespace calc
 {
 
@@ -15,44 +17,33 @@ using namespace lingo;
 struct Expr;
 
 
-// Denotes a parse error.
-struct Parse_error : std::runtime_error
-{
-  using std::runtime_error::runtime_error;
-};
-
-
 // The parser is responsible for transforming a stream of tokens
 // into nodes. The parser owns a reference to the buffer for its
 // tokens. This supports the resolution of source code locations.
+//
+// The grammar is defined by rules built from parser combinators
+// (see lingo/combinator.hpp). Binary expressions are parsed by
+// precedence climbing over the operator table (see lingo/pratt.hpp).
+//
+// The parser does not throw exceptions. If the input is not an
+// expression, the error is diagnosed and the result is an error
+// node.
 struct Parser
 {
-  Parser(Token_stream& ts)
-    : ts_(ts)
-  { }
+  Parser(Token_stream&);
 
   Expr const* operator()();
 
-  Expr const* paren();
-  Expr const* primary();
-  Expr const* unary();
-  Expr const* multiplicative();
-  Expr const* additive();
-  Expr const* binary();
-  Expr const* expr();
-
   Expr const* on_int(Token);
+  Expr const* on_paren(Token, Expr const*, Token);
   Expr const* on_unary(Token, Expr const*);
-  Expr const* on_binary(Token, Expr const*, Expr const*);
-
-  Token_kind lookahead() const;
-  Token_kind lookahead(int) const;
-  Token      match(Token_kind);
-  Token      match_if(Token_kind);
-  Token      require(Token_kind);
-  Token      accept();
 
   Token_stream& ts_;
+
+  // Grammar
+  Rule<Expr const*> primary;
+  Rule<Expr const*> unary;
+  Rule<Expr const*> expr;
 };
 
 
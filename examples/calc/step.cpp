@@ -5,43 +5,45 @@
 #include "ast.hpp"
 #include "parser.hpp"
 
+#include <lingo/arena.hpp>
 #include <lingo/error.hpp>
+#include <lingo/rewrite.hpp>
+#include <lingo/trace.hpp>
 
 #include <iostream>
 
 namespace calc
 {
 
-Expr const* step(Expr const*);
+Expr const* step(Rewriter&, Expr const*);
 Expr const* next(Expr const*);
 
 
 // Reduce each operand in turn. Evaluation proceeds left-to-right.
+// Only the nodes on the path to the reduced operand are copied.
 template<typename T>
 Expr const*
-step_binary(T const* e)
+step_binary(Rewriter& rw, T const* e)
 {
-  Location loc = e->location();
   Expr const* e1 = e->left();
   Expr const* e2 = e->right();
   if (!is<Int>(e1))
-    return new T(loc, step(e1), e2);
+    return rw.update(e, step(rw, e1), e2);
   if (!is<Int>(e2))
-    return new T(loc, e1, step(e2));
-  return new Int(loc, evaluate(e));
+    return rw.update(e, e1, step(rw, e2));
+  return rw.make<Int>(e->location(), evaluate(e));
 }
 
 
 // Reduce the operand.
 template<typename T>
 Expr const*
-step_unary(T const* e)
+step_unary(Rewriter& rw, T const* e)
 {
-  Location loc = e->location();
   Expr const* e0 = e->arg();
   if (!is<Int>(e0))
-    return new T(loc, step(e0));
-  return new Int(loc, evaluate(e));
+    return rw.update(e, step(rw, e0));
+  return rw.make<Int>(e->location(), evaluate(e));
 }
 
 
@@ -49,21 +51,23 @@ step_unary(T const* e)
 struct Step_fn
 {
   Expr const* operator()(Int const* e) const { return e; }
-  Expr const* operator()(Add const* e) const { return step_binary(e); }
-  Expr const* operator()(Sub const* e) const { return step_binary(e); }
-  Expr const* operator()(Mul const* e) const { return step_binary(e); }
-  Expr const* operator()(Div const* e) const { return step_binary(e); }
-  Expr const* operator()(Mod const* e) const { return step_binary(e); }
-  Expr const* operator()(Neg const* e) const { return step_unary(e); }
-  Expr const* operator()(Pos const* e) const { return step_unary(e); }
+  Expr const* operator()(Add const* e) const { return step_binary(rw, e); }
+  Expr const* operator()(Sub const* e) const { return step_binary(rw, e); }
+  Expr const* operator()(Mul const* e) const { return step_binary(rw, e); }
+  Expr const* operator()(Div const* e) const { return step_binary(rw, e); }
+  Expr const* operator()(Mod const* e) const { return step_binary(rw, e); }
+  Expr const* operator()(Neg const* e) const { return step_unary(rw, e); }
+  Expr const* operator()(Pos const* e) const { return step_unary(rw, e); }
+
+  Rewriter& rw;
 };
 
 
 // Compute the integer evaluation of the expression.
 Expr const*
-step(Expr const* e)
+step(Rewriter& rw, Expr const* e)
 {
-  return apply(e, Step_fn());
+  return apply(e, Step_fn{rw});
 }
 
 
@@ -119,22 +123,29 @@ next(Expr const* e)
 
 // Iterate through the evaluation of the expression, showing
 // which expressions are being evaluated.
-Expr const*
+void
 step_eval(Expr const* e)
 {
+  lingo_trace_scope("evaluate");
+  Arena arena;
+  Rewriter rw(arena);
+  Arena::Watermark w = arena.watermark();
   do {
     // Reparse the input so that source locations line
     // up in each printing.
     e = parse(to_string(e));
 
+    // The previous version has been reparsed, so release
+    // the nodes made for it.
+    arena.rollback(w);
+
     // Select the sub-expression being evaluated.
     note(next(e)->span(), "evaluating");
 
     // Perform that evaluation.
-    e = step(e);
+    e = step(rw, e);
   } while (!is<Int>(e));
   std::cout << *e << '\n';
-  return e;
 }
 
 
@@ -10,7 +10,7 @@ namespace calc
 struct Expr;
 
 
-Expr const* step_eval(Expr const*);
+void step_eval(Expr const*);
 
 
 } // namespace calc
@@ -0,0 +1,92 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+// Measures the throughput of each phase of the calc pipeline
+// on a generated corpus (see bench/pipeline.hpp). As in the
+// interpreter, each line is translated separately.
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "ast.hpp"
+
+#include <lingo/file.hpp>
+#include <lingo/error.hpp>
+
+#include <bench/pipeline.hpp>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+
+using namespace lingo;
+using namespace calc;
+
+
+// Initialize the token set used by the language.
+void
+init_tokens()
+{
+  symbols.put_symbol(lparen_tok, "(");
+  symbols.put_symbol(rparen_tok, ")");
+  symbols.put_symbol(plus_tok, "+");
+  symbols.put_symbol(minus_tok, "-");
+  symbols.put_symbol(star_tok, "*");
+  symbols.put_symbol(slash_tok, "/");
+}
+
+
+void
+translate(bench::Pipeline& p, char const* path)
+{
+  // Loading includes splitting the file into buffers for
+  // each line.
+  std::vector<std::unique_ptr<Buffer>> lines;
+  p.phase("load", [&]() {
+    File input(path);
+    for (auto const& x : input.lines()) {
+      Line const& l = x.second;
+      if (l.begin() != l.end())
+        lines.emplace_back(new Buffer(String(l.begin(), l.end())));
+    }
+  });
+
+  std::vector<std::unique_ptr<Token_stream>> streams;
+  std::uint64_t tokens = 0;
+  p.phase("lex", [&]() {
+    for (auto const& buf : lines) {
+      Character_stream cs(*buf);
+      streams.emplace_back(new Token_stream(*buf));
+      Lexer lex(cs, *streams.back());
+      lex();
+      tokens += streams.back()->buf_.size();
+    }
+  });
+  if (error_count())
+    throw std::runtime_error("lexical errors in corpus");
+  p.set_tokens(tokens);
+
+  std::vector<Expr const*> exprs;
+  p.phase("parse", [&]() {
+    for (auto const& ts : streams) {
+      Parser parse(*ts);
+      exprs.push_back(parse());
+    }
+  });
+  if (error_count())
+    throw std::runtime_error("syntax errors in corpus");
+
+  Integer sum;
+  p.phase("evaluate", [&]() {
+    for (Expr const* e : exprs)
+      sum = evaluate(e);
+  });
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  init_tokens();
+  return bench::run_pipeline(argc, argv, bench::calc_lang, translate);
+}
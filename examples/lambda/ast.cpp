@@ -11,6 +11,18 @@
 namespace calc
 {
 
+// Returns the current node factory, or a shared factory when no
+// factory scope is active.
+Node_factory&
+nodes()
+{
+  if (Node_factory* f = current_node_factory())
+    return *f;
+  static Node_factory f;
+  return f;
+}
+
+
 void
 print(std::ostream& os, Var const* e)
 {
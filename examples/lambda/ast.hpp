@@ -6,6 +6,7 @@
 
 #include "lingo/integer.hpp"
 #include "lingo/node.hpp"
+#include "lingo/memory.hpp"
 #include "lingo/token.hpp"
 #include "lingo/print.hpp"
 
@@ -34,7 +35,7 @@ struct Visitor;
 //          \x.e    -- abstractions
 //          e1 e2   -- applications
 //          e1 ; e2 -- sequences
-struct Expr
+struct Expr : Numbered_node
 {
   Expr()
     : loc_()
@@ -208,6 +209,27 @@ apply(Expr const* e, F fn)
 }
 
 
+// -------------------------------------------------------------------------- //
+// Node creation
+
+// Terms are created by the node factory, which numbers them
+// so that analyses can save their results in side tables. Each
+// program is translated and evaluated in the scope of its own
+// factory (see main.cpp), so that the ids of its terms are dense.
+// Terms made outside of any factory scope are numbered by a
+// factory shared by the process.
+Node_factory& nodes();
+
+
+// Create a term of type T.
+template<typename T, typename... Args>
+inline T*
+make_node(Args&&... args)
+{
+  return nodes().make<T>(std::forward<Args>(args)...);
+}
+
+
 // -------------------------------------------------------------------------- //
 // Facilities
 
@@ -0,0 +1,131 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+// Compares the time taken to reparse a document after a small
+// edit with that of translating the edited text from scratch.
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "document.hpp"
+
+#include <lingo/io.hpp>
+#include <lingo/error.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+
+using namespace lingo;
+using namespace calc;
+
+
+// Initialize the token set used by the language.
+void
+init_tokens()
+{
+  symbols.put_symbol(lparen_tok, "(");
+  symbols.put_symbol(rparen_tok, ")");
+  symbols.put_symbol(backslash_tok, "\\");
+  symbols.put_symbol(dot_tok, ".");
+  symbols.put_symbol(equal_tok, "=");
+  symbols.put_symbol(semicolon_tok, ";");
+}
+
+
+// Returns a distinct identifier for each `n`. Identifiers
+// consist only of letters.
+String
+name(int n)
+{
+  String str = "f";
+  do {
+    str += char('a' + n % 26);
+    n /= 26;
+  } while (n);
+  return str;
+}
+
+
+// Generate a program of `n` definitions, saving the offset of
+// the semicolon that ends each in `ends`.
+String
+generate(int n, std::vector<int>& ends)
+{
+  std::stringstream ss;
+  ss << "a = \\x.x;\n";
+  for (int i = 0; i < n; ++i) {
+    ss << name(i) << " = \\x.\\y.a (x y)";
+    ends.push_back(ss.tellp());
+    ss << ";\n";
+  }
+  return ss.str();
+}
+
+
+// Returns the printed form of the program.
+String
+to_string(Expr const* e)
+{
+  std::stringstream ss;
+  if (e)
+    ss << *e;
+  return ss.str();
+}
+
+
+// Returns the number of milliseconds taken to call `f`.
+template<typename F>
+double
+measure(F f)
+{
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  f();
+  Clock::time_point stop = Clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  init_colors();
+  init_tokens();
+
+  int n = argc > 1 ? std::atoi(argv[1]) : 10000;
+  int edits = argc > 2 ? std::atoi(argv[2]) : 100;
+  if (n <= 0 || edits <= 0) {
+    std::cerr << "usage: lambda_bench [<statements> [<edits>]]\n";
+    return -1;
+  }
+
+  std::vector<int> ends;
+  Document doc(generate(n, ends));
+
+  // Each edit extends a statement with an application, and the
+  // next removes it again. Check that the incremental parse
+  // agrees with a complete parse after each edit.
+  double full_ms = 0;
+  double incr_ms = 0;
+  for (int k = 0; k < edits; ++k) {
+    int i = (k / 2 * 7919) % n;
+    Text_edit e = k % 2 == 0 ? Text_edit{ends[i], 0, " a"} : Text_edit{ends[i], 2, ""};
+    incr_ms += measure([&]() { doc.edit(e); });
+
+    Document* full = nullptr;
+    full_ms += measure([&]() { full = new Document(doc.buffer().str()); });
+    if (error_count() || to_string(doc.program()) != to_string(full->program())) {
+      std::cerr << "error: incremental parse differs after edit " << k << '\n';
+      return 1;
+    }
+    delete full;
+  }
+
+  std::cout << "statements:  " << n << ", edits: " << edits << '\n';
+  std::cout << "full:        " << full_ms / edits << " ms/edit\n";
+  std::cout << "incremental: " << incr_ms / edits << " ms/edit\n";
+  return 0;
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "document.hpp"
+
+#include <lingo/trace.hpp>
+
+namespace calc
+{
+
+
+// Lex and parse the program.
+Document::Document(String const& str)
+  : buf_(str), ts_(buf_), prog_(nullptr)
+{
+  Character_stream cs(buf_);
+  Lexer lex(cs, ts_);
+  lex();
+  prog_ = parse();
+}
+
+
+// Apply the edit and reparse the program, returning the
+// new program.
+Expr const*
+Document::edit(Text_edit const& e)
+{
+  Damage d;
+  {
+    lingo_trace_scope("lex");
+    d = relex(buf_, ts_, e, [this](Character_stream& cs) {
+      Lexer lex(cs, ts_);
+      return lex.scan();
+    });
+  }
+  stmts_.damage(d);
+  prog_ = parse();
+  return prog_;
+}
+
+
+// Parse the program from the first token, reusing the
+// statements saved by the previous parse.
+Expr const*
+Document::parse()
+{
+  Parser parse(ts_, &stmts_);
+  return parse();
+}
+
+
+} // namespace calc
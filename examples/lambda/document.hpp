@@ -0,0 +1,51 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef CALC_DOCUMENT_HPP
+#define CALC_DOCUMENT_HPP
+
+// The document module supports editing a program without
+// translating all of it after each edit.
+
+#include "lexer.hpp"
+#include "parser.hpp"
+
+#include <lingo/incremental.hpp>
+
+namespace calc
+{
+
+
+// A document is the text of a program that is edited. After
+// an edit, only the tokens that overlap it are relexed, and
+// only the statements that contain those tokens, or that use
+// names whose definitions were reparsed, are parsed again.
+// Other statements are reused from the previous parse.
+//
+// Errors are diagnosed in the active diagnostic context.
+class Document
+{
+public:
+  Document(String const&);
+
+  Expr const* edit(Text_edit const&);
+
+  // Returns the text of the program.
+  Buffer const& buffer() const { return buf_; }
+
+  // Returns the program, or null if it is empty.
+  Expr const* program() const { return prog_; }
+
+private:
+  Expr const* parse();
+
+  Buffer          buf_;
+  Token_stream    ts_;
+  Statement_table stmts_;
+  Expr const*     prog_;
+};
+
+
+} // namespace calc
+
+#endif
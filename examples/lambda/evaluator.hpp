@@ -21,11 +21,19 @@ using Value_binding = Value_map::Binding;
 
 
 struct Expr;
+struct Memo_table;
 
 
 // The evaluator...
+//
+// When given a memo table, the results of applications are
+// recorded and reused for structurally equal applications.
 struct Evaluator
 {
+  Evaluator(Memo_table* m = nullptr)
+    : memo_(m)
+  { }
+
   Expr const* operator()(Expr const*);
 
   Expr const* eval(Expr const*);
@@ -36,7 +44,8 @@ struct Evaluator
   Expr const* eval(App const*);
   Expr const* eval(Seq const*);
 
-  Value_map defs_;
+  Value_map   defs_;
+  Memo_table* memo_;
 };
 
 
@@ -4,12 +4,21 @@
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "evaluator.hpp"
+#include "memo.hpp"
 
 #include <lingo/file.hpp>
+#include <lingo/driver.hpp>
 #include <lingo/io.hpp>
 #include <lingo/error.hpp>
+#include <lingo/trace.hpp>
+#include <lingo/accounting.hpp>
 
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
 
 
 using namespace lingo;
@@ -29,18 +38,22 @@ init_tokens()
 }
 
 
-int
-main(int argc, char* argv[])
+// A translated program. Its terms are numbered by its own node
+// factory, which also numbers the terms made by evaluating it.
+struct Translation
 {
-  init_colors();
-  init_tokens();
+  Expr const*                   expr;
+  std::unique_ptr<Node_factory> nodes;
+};
 
-  if (argc != 2) {
-    std::cerr << "usage: lambda <input-file>\n";
-    return -1;
-  }
 
-  File input(argv[1]);
+// Lex and parse the file. The expression is null if the program
+// is ill-formed.
+Translation
+translate(File& input)
+{
+  Translation t {nullptr, std::unique_ptr<Node_factory>(new Node_factory())};
+  Node_factory_scope scope(*t.nodes);
   Character_stream cs(input);
   Token_stream ts(input);
   Lexer lex(cs, ts);
@@ -49,16 +62,85 @@ main(int argc, char* argv[])
   // Transform characters into tokens.
   lex();
   if (error_count())
-    return -1;
+    return t;
 
   // Transform tokens into abstract syntax.
   Expr const* expr = parse();
-  if (error_count())
+  if (!error_count())
+    t.expr = expr;
+  return t;
+}
+
+
+// Print the program usage.
+int
+usage()
+{
+  std::cerr << "usage: lambda [--memo[=<n>]] [--memory] [--trace[-counters]=<file>] <input-file>...\n";
+  return -1;
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  init_colors();
+  init_tokens();
+
+  // Process command line options. The --memo option enables
+  // memoization of applications, optionally limiting the
+  // number of memoized results. The --memory option prints the
+  // memory used by lingo. The --trace option records the
+  // time spent in each phase and writes it to the given file in
+  // the Chrome trace event format. The --trace-counters option
+  // also records hardware counters for each phase.
+  //
+  // Each input file is a separate program. Files are translated
+  // in parallel and then evaluated in the order given. Each
+  // program has its own memo table, since the tables are indexed
+  // by the ids of the program's terms.
+  std::vector<std::string> paths;
+  std::size_t memo = 0;
+  std::unique_ptr<Trace_file> trace;
+  bool memory = false;
+  for (int i = 1; i < argc; ++i) {
+    char const* arg = argv[i];
+    if (std::strcmp(arg, "--memo") == 0)
+      memo = Memo_table::default_capacity;
+    else if (std::strncmp(arg, "--memo=", 7) == 0 && std::atoi(arg + 7) > 0)
+      memo = std::atoi(arg + 7);
+    else if (std::strcmp(arg, "--memory") == 0)
+      memory = true;
+    else if (std::strncmp(arg, "--trace=", 8) == 0)
+      trace.reset(new Trace_file(arg + 8));
+    else if (std::strncmp(arg, "--trace-counters=", 17) == 0)
+      trace.reset(new Trace_file(arg + 17, true));
+    else if (arg[0] != '-')
+      paths.push_back(arg);
+    else
+      return usage();
+  }
+  if (paths.empty())
+    return usage();
+
+  std::vector<File_result<Translation>> files = process_files(paths, translate);
+  if (report_diagnostics(files))
     return 1;
-  // std::cout << "Parsed:\n" << *expr << '\n';
 
-  Evaluator eval;
-  Expr const* result = eval(expr);
-  if (result)
-    std::cout << *result << '\n';
+  std::vector<std::unique_ptr<Memo_table>> memos;
+  for (File_result<Translation> const& f : files) {
+    // std::cout << "Parsed:\n" << *f.result.expr << '\n';
+    Node_factory_scope scope(*f.result.nodes);
+    if (memo)
+      memos.emplace_back(new Memo_table(memo));
+    Evaluator eval(memo ? memos.back().get() : nullptr);
+    Expr const* result = eval(f.result.expr);
+    if (result)
+      std::cout << *result << '\n';
+  }
+
+  for (std::unique_ptr<Memo_table> const& m : memos)
+    print_statistics(std::cerr, *m);
+  if (memory)
+    report_memory_usage(std::cerr);
 }
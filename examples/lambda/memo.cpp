@@ -0,0 +1,284 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "memo.hpp"
+
+#include <iostream>
+#include <typeindex>
+#include <vector>
+
+namespace calc
+{
+
+namespace
+{
+
+// Tags distinguish the kinds of terms in structural hashes.
+enum Term_tag
+{
+  var_tag,
+  bound_tag,
+  free_tag,
+  unbound_tag,
+  def_tag,
+  abs_tag,
+  app_tag,
+  seq_tag
+};
+
+
+// The binder stack records the variables bound by enclosing
+// abstractions, innermost last.
+using Binder_stack = std::vector<Var const*>;
+
+
+// Returns the de Bruijn index of `v` in the binder stack, or
+// -1 if `v` is not bound by an enclosing abstraction.
+int
+binder_index(Binder_stack const& s, Var const* v)
+{
+  for (std::size_t i = s.size(); i != 0; --i) {
+    if (s[i - 1] == v)
+      return s.size() - i;
+  }
+  return -1;
+}
+
+
+// Computes the structural hash of a term. Bound variables are
+// hashed by their de Bruijn index so that alpha-equivalent terms
+// have the same hash. Free variables are hashed by identity.
+struct Hash_fn
+{
+  std::size_t operator()(Var const* e)
+  {
+    return var_tag;
+  }
+
+  std::size_t operator()(Ref const* e)
+  {
+    if (!e->var())
+      return hash_combine(unbound_tag, std::hash<Symbol const*>()(e->name()));
+    int n = binder_index(binders, e->var());
+    if (n < 0)
+      return hash_combine(free_tag, std::hash<Var const*>()(e->var()));
+    return hash_combine(bound_tag, n);
+  }
+
+  std::size_t operator()(Def const* e)
+  {
+    std::size_t h = hash_combine(def_tag, std::hash<Var const*>()(e->var()));
+    return hash_combine(h, hash(e->expr()));
+  }
+
+  std::size_t operator()(Abs const* e)
+  {
+    binders.push_back(e->var());
+    std::size_t h = hash_combine(abs_tag, hash(e->expr()));
+    binders.pop_back();
+    return h;
+  }
+
+  std::size_t operator()(App const* e)
+  {
+    std::size_t h = hash_combine(app_tag, hash(e->fn()));
+    return hash_combine(h, hash(e->arg()));
+  }
+
+  std::size_t operator()(Seq const* e)
+  {
+    std::size_t h = hash_combine(seq_tag, hash(e->left()));
+    return hash_combine(h, hash(e->right()));
+  }
+
+  std::size_t hash(Expr const* e)
+  {
+    return apply(e, *this);
+  }
+
+  Binder_stack& binders;
+};
+
+
+// Determines if two terms are alpha-equivalent. The binder
+// stacks of each term are extended in lock-step so that bound
+// variables can be compared by their de Bruijn indexes.
+struct Equal_fn
+{
+  bool operator()(Var const* a)
+  {
+    return true;
+  }
+
+  bool operator()(Ref const* a)
+  {
+    Ref const* b = cast<Ref>(other);
+    if (!a->var() || !b->var())
+      return !a->var() && !b->var() && a->name() == b->name();
+    int m = binder_index(left, a->var());
+    int n = binder_index(right, b->var());
+    if (m < 0 && n < 0)
+      return a->var() == b->var();
+    return m == n;
+  }
+
+  bool operator()(Def const* a)
+  {
+    Def const* b = cast<Def>(other);
+    return a->var() == b->var() && equal(a->expr(), b->expr());
+  }
+
+  bool operator()(Abs const* a)
+  {
+    Abs const* b = cast<Abs>(other);
+    left.push_back(a->var());
+    right.push_back(b->var());
+    bool r = equal(a->expr(), b->expr());
+    left.pop_back();
+    right.pop_back();
+    return r;
+  }
+
+  bool operator()(App const* a)
+  {
+    App const* b = cast<App>(other);
+    return equal(a->fn(), b->fn()) && equal(a->arg(), b->arg());
+  }
+
+  bool operator()(Seq const* a)
+  {
+    Seq const* b = cast<Seq>(other);
+    return equal(a->left(), b->left()) && equal(a->right(), b->right());
+  }
+
+  bool equal(Expr const* a, Expr const* b)
+  {
+    if (a == b && left == right)
+      return true;
+    if (std::type_index(typeid(*a)) != std::type_index(typeid(*b)))
+      return false;
+    Expr const* save = other;
+    other = b;
+    bool r = apply(a, *this);
+    other = save;
+    return r;
+  }
+
+  Binder_stack& left;
+  Binder_stack& right;
+  Expr const*   other;
+};
+
+
+} // namespace
+
+
+// Returns the structural hash of `e`.
+std::size_t
+hash_term(Expr const* e)
+{
+  Binder_stack s;
+  Hash_fn fn{s};
+  return fn.hash(e);
+}
+
+
+// Returns true if `a` and `b` are alpha-equivalent.
+bool
+equal_terms(Expr const* a, Expr const* b)
+{
+  Binder_stack s1;
+  Binder_stack s2;
+  Equal_fn fn{s1, s2, nullptr};
+  return fn.equal(a, b);
+}
+
+
+// Returns true if the evaluation of `e` has no side effects.
+// Evaluating a definition binds a name, and evaluating a
+// sequence prints its left operand.
+bool
+is_pure_term(Expr const* e)
+{
+  struct Fn
+  {
+    bool operator()(Var const* e) { return true; }
+    bool operator()(Ref const* e) { return true; }
+    bool operator()(Def const* e) { return false; }
+    bool operator()(Abs const* e) { return is_pure_term(e->expr()); }
+    bool operator()(App const* e) { return is_pure_term(e->fn()) && is_pure_term(e->arg()); }
+    bool operator()(Seq const* e) { return false; }
+  };
+  return apply(e, Fn{});
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Hash consing
+
+
+// Returns the cached information about `e`, computing it
+// if `e` has not been seen before.
+Term_info const&
+Term_table::info(Expr const* e) const
+{
+  if (Term_info const* i = info_.find(e->node_id()))
+    return *i;
+  return info_.put(e->node_id(), Term_info{hash_term(e), is_pure_term(e)});
+}
+
+
+// Returns the canonical representative of `e`. If no
+// structurally equal term has been interned, `e` becomes
+// the representative of its class.
+Expr const*
+Term_table::intern(Expr const* e)
+{
+  if (Expr const* const* c = canon_.find(e->node_id()))
+    return *c;
+  Expr const* c = *terms_.insert(e).first;
+  canon_.put(e->node_id(), c);
+  return c;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Memo table
+
+
+// Returns the memoized result of applying `fn` to `arg`, or
+// nullptr if no such application has been recorded.
+Expr const*
+Memo_table::get(Expr const* fn, Expr const* arg)
+{
+  if (!terms_.info(fn).pure || !terms_.info(arg).pure)
+    return nullptr;
+  Memo_key k {terms_.intern(fn), terms_.intern(arg)};
+  if (Expr const* const* r = cache_.get(k))
+    return *r;
+  return nullptr;
+}
+
+
+// Record `result` as the value of applying `fn` to `arg`.
+void
+Memo_table::put(Expr const* fn, Expr const* arg, Expr const* result)
+{
+  if (!terms_.info(fn).pure || !terms_.info(arg).pure)
+    return;
+  Memo_key k {terms_.intern(fn), terms_.intern(arg)};
+  cache_.put(k, result);
+}
+
+
+// Print a summary of memoization performance.
+void
+print_statistics(std::ostream& os, Memo_table const& m)
+{
+  os << "memo: " << m.stats() << '\n';
+  os << "memo: " << m.cache_.size() << " of " << m.cache_.capacity()
+     << " entries used, " << m.terms_.size() << " distinct terms\n";
+}
+
+
+} // namespace calc
@@ -0,0 +1,149 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef CALC_MEMO_HPP
+#define CALC_MEMO_HPP
+
+// The memo module supports the memoization of applications
+// during evaluation. Terms are compared structurally, up to
+// the renaming of bound variables (alpha-equivalence), so that
+// re-applying the same combinator to the same argument can
+// reuse a previously computed result.
+
+#include "ast.hpp"
+
+#include <lingo/analysis.hpp>
+#include <lingo/cache.hpp>
+
+#include <iosfwd>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace calc
+{
+
+using namespace lingo;
+
+
+std::size_t hash_term(Expr const*);
+bool        equal_terms(Expr const*, Expr const*);
+bool        is_pure_term(Expr const*);
+
+
+// -------------------------------------------------------------------------- //
+//                            Hash consing
+
+// Information computed for each term the first time it is
+// interned.
+struct Term_info
+{
+  std::size_t hash; // The structural hash of the term
+  bool        pure; // True if evaluation has no side effects
+};
+
+
+// The term table maps each term to a canonical representative
+// of its alpha-equivalence class. Two terms are interned to the
+// same pointer iff they are structurally equal.
+//
+// Interning a term computes its structural hash, which requires
+// a full traversal. That information is cached for each node
+// seen so that re-interning the same node is constant time.
+// The information is saved in side tables, indexed by node id,
+// so a table shall only intern the terms of one node factory.
+// Note that this relies on terms never being deallocated.
+struct Term_table
+{
+  struct Hash
+  {
+    Term_table const* tab;
+    std::size_t operator()(Expr const* e) const { return tab->info(e).hash; }
+  };
+
+  struct Eq
+  {
+    bool operator()(Expr const* a, Expr const* b) const { return equal_terms(a, b); }
+  };
+
+  Term_table()
+    : terms_(0, Hash{this}, Eq{})
+  { }
+
+  Term_table(Term_table const&) = delete;
+  Term_table& operator=(Term_table const&) = delete;
+
+  Expr const*      intern(Expr const*);
+  Term_info const& info(Expr const*) const;
+
+  // Returns the number of distinct terms in the table.
+  std::size_t size() const { return terms_.size(); }
+
+  using Term_set  = std::unordered_set<Expr const*, Hash, Eq>;
+  using Info_map  = Side_table<Term_info>;
+  using Canon_map = Side_table<Expr const*>;
+
+  Term_set         terms_; // Canonical terms
+  mutable Info_map info_;  // Hashes and purity of seen nodes
+  Canon_map        canon_; // Canonical representatives of seen nodes
+};
+
+
+// -------------------------------------------------------------------------- //
+//                            Memo table
+
+// The key of a memoized application is the pair of canonical
+// function and argument terms.
+struct Memo_key
+{
+  Expr const* fn;
+  Expr const* arg;
+};
+
+
+inline bool
+operator==(Memo_key const& a, Memo_key const& b)
+{
+  return a.fn == b.fn && a.arg == b.arg;
+}
+
+
+struct Memo_key_hash
+{
+  std::size_t operator()(Memo_key const& k) const
+  {
+    std::hash<Expr const*> h;
+    return hash_combine(h(k.fn), h(k.arg));
+  }
+};
+
+
+// The memo table records the results of evaluated applications
+// in a bounded LRU cache. Only applications of pure terms (those
+// without definitions or sequences, whose evaluation has side
+// effects) are memoized.
+struct Memo_table
+{
+  explicit Memo_table(std::size_t n = default_capacity)
+    : cache_(n)
+  { }
+
+  Expr const* get(Expr const*, Expr const*);
+  void        put(Expr const*, Expr const*, Expr const*);
+
+  Cache_stats const& stats() const { return cache_.stats(); }
+
+  static constexpr std::size_t default_capacity = 4096;
+
+  using Cache = Lru_cache<Memo_key, Expr const*, Memo_key_hash>;
+
+  Term_table terms_;
+  Cache      cache_;
+};
+
+
+void print_statistics(std::ostream&, Memo_table const&);
+
+
+} // namespace calc
+
+#endif
@@ -6,8 +6,13 @@
 #include "ast.hpp"
 
 #include <lingo/error.hpp>
+#include <lingo/node.hpp>
+#include <lingo/trace.hpp>
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <utility>
 
 namespace calc
 {
@@ -30,6 +35,10 @@ token_spelling(Token_stream& ts)
 }
 
 
+// Parsing resumes at the next statement after a syntax error.
+constexpr Token_set stmt_sync {semicolon_tok};
+
+
 } // namespace
 
 
@@ -49,6 +58,9 @@ Parser::lookahead(int n) const
 }
 
 
+// If the current token matches k, return the token and
+// advance the stream. Otherwise, diagnose the error and
+// return an invalid token.
 Token
 Parser::match(Token_kind k)
 {
@@ -58,8 +70,8 @@ Parser::match(Token_kind k)
   String msg = format("expected '{}' but got '{}'",
                       get_spelling(k),
                       token_spelling(ts_));
-  error(ts_.location(), msg);
-  throw Parse_error("match");
+  recovery_.error(ts_.location(), msg);
+  return Token();
 }
 
 
@@ -104,7 +116,9 @@ Parser::accept()
 Var const*
 Parser::var()
 {
-  Token tok = require(identifier_tok);
+  Token tok = match(identifier_tok);
+  if (!tok)
+    return make_error_node<Var>();
   return on_var(tok);
 }
 
@@ -122,8 +136,10 @@ Parser::def()
 {
   Var const* v = var();
   require(equal_tok);
-  Expr const* e = expr();
-  return on_def(v, e);
+  Required<Expr> e = expr();
+  if (!e)
+    return make_error_node<Expr>();
+  return on_def(v, *e);
 }
 
 
@@ -132,10 +148,13 @@ Parser::abs()
 {
   Environment env(*this);
   require(backslash_tok);
-  Var const* v = var();
-  match(dot_tok);
-  Expr const* e = expr();
-  return on_abs(v, e);
+  Required<Var> v = var();
+  if (!v || !match(dot_tok))
+    return make_error_node<Expr>();
+  Required<Expr> e = expr();
+  if (!e)
+    return make_error_node<Expr>();
+  return on_abs(*v, *e);
 }
 
 
@@ -143,9 +162,10 @@ Expr const*
 Parser::paren()
 {
   this->require(lparen_tok);
-  Expr const* e = expr();
-  match(rparen_tok);
-  return e;
+  Required<Expr> e = expr();
+  if (!e || !match(rparen_tok))
+    return make_error_node<Expr>();
+  return *e;
 }
 
 
@@ -166,8 +186,8 @@ Parser::primary()
     return abs();
   if (lookahead() == lparen_tok)
     return paren();
-  error(ts_.location(), "expected primary-expression");
-  throw Parse_error("primary");
+  recovery_.error(ts_.location(), "expected primary-expression");
+  return make_error_node<Expr>();
 }
 
 
@@ -183,18 +203,24 @@ Parser::app()
 Expr const*
 Parser::postfix()
 {
-  Expr const* e = primary();
+  Required<Expr> e1 = primary();
+  if (!e1)
+    return make_error_node<Expr>();
   while (true) {
     // We have an application only when the lookahead
     // indicates the start of a new primary expression.
     if (lookahead() == identifier_tok ||
         lookahead() == backslash_tok ||
-        lookahead() == lparen_tok)
-      e = on_app(e, primary());
+        lookahead() == lparen_tok) {
+      Required<Expr> e2 = primary();
+      if (!e2)
+        return make_error_node<Expr>();
+      e1 = on_app(*e1, *e2);
+    }
     else
       break;
   }
-  return e;
+  return *e1;
 }
 
 
@@ -205,15 +231,90 @@ Parser::expr()
 }
 
 
+// stmt: expr
+//
+// A statement is followed by a semicolon or the end of input.
+// If the statement is ill-formed, the parser skips to the next
+// semicolon, so that parsing resumes with the next statement.
+//
+// If statements are being saved, a statement saved by the
+// previous parse is reused where possible, and a well-formed
+// statement is saved for the next parse.
+Expr const*
+Parser::stmt()
+{
+  if (stmts_) {
+    if (Expr const* e = reuse())
+      return e;
+  }
+
+  Statement s {};
+  Token first = ts_.peek();
+  stmt_ = stmts_ ? &s : nullptr;
+  Required<Expr> e = expr();
+  stmt_ = nullptr;
+  if (e && !ts_.eof() && lookahead() != semicolon_tok) {
+    String msg = format("expected ';' but got '{}'", token_spelling(ts_));
+    recovery_.error(ts_.location(), msg);
+    e = make_error_node<Expr>();
+  }
+  if (!e) {
+    recovery_.synchronize(ts_, stmt_sync);
+    return *e;
+  }
+
+  if (stmts_) {
+    auto last = std::prev(ts_.position());
+    s.expr = *e;
+    stmts_->save({first.location().offset(), token_end(*last), last, std::move(s)});
+  }
+  return *e;
+}
+
+
+// If a statement saved by the previous parse begins at the
+// current token, is still followed by a semicolon or the end
+// of input, and the names it uses refer to the same variables,
+// skip its tokens and return it. Otherwise, return null.
+Expr const*
+Parser::reuse()
+{
+  if (ts_.eof())
+    return nullptr;
+  Statement_table::Entry* ent = stmts_->find(ts_.peek().location().offset());
+  if (!ent)
+    return nullptr;
+  for (Name_use const& use : ent->value.uses) {
+    Name_binding const* bind = names_.lookup(use.first);
+    if ((bind ? bind->second : nullptr) != use.second)
+      return nullptr;
+  }
+
+  auto start = ts_.position();
+  ts_.reposition(std::next(ent->last_tok));
+  if (!ts_.eof() && lookahead() != semicolon_tok) {
+    ts_.reposition(start);
+    return nullptr;
+  }
+  for (Var const* v : ent->value.defs)
+    names_.bind(v->name(), v);
+  Expr const* e = ent->value.expr;
+  stmts_->save(std::move(*ent));
+  return e;
+}
+
+
+// seq: seq ';' stmt
+//      stmt [;]
 Expr const*
 Parser::seq()
 {
-  Expr const* e = postfix();
+  Expr const* e = stmt();
   while (true) {
     if (match_if(semicolon_tok)) {
       if (ts_.eof())
         return e;
-      e = on_seq(e, expr());
+      e = on_seq(e, stmt());
     }
     else
       break;
@@ -225,10 +326,12 @@ Parser::seq()
 Expr const*
 Parser::operator()()
 {
+  lingo_trace_scope("parse");
   Environment env(*this);
-  if (ts_.eof())
-    return nullptr;
-  return seq();
+  Expr const* e = ts_.eof() ? nullptr : seq();
+  if (stmts_)
+    stmts_->commit();
+  return e;
 }
 
 
@@ -240,50 +343,65 @@ Var const*
 Parser::on_var(Token tok)
 {
   Symbol const* sym = tok.symbol();
-  Var* v = new Var(sym);
+  Var* v = make_node<Var>(sym);
   names_.bind(sym, v);
+  if (stmt_ && names_.size() == 1)
+    stmt_->defs.push_back(v);
   return v;
 }
 
 
 // Return a reference to the bound variable (if bound)
 // or simply the symbol (if unbound).
+//
+// When saving a statement, record the uses of names that
+// are not bound within the statement.
 Expr const*
 Parser::on_id(Token tok)
 {
   Symbol const* sym = tok.symbol();
-  if (Name_binding const* bind = names_.lookup(sym))
-    return new Ref(sym, bind->second);
+  Name_binding const* bind = names_.lookup(sym);
+  Var const* var = bind ? bind->second : nullptr;
+  if (stmt_ && (!bind || bind->scope == 0)) {
+    auto const& defs = stmt_->defs;
+    if (std::find(defs.begin(), defs.end(), var) == defs.end())
+      stmt_->uses.emplace_back(sym, var);
+  }
+  if (bind)
+    return make_node<Ref>(sym, var);
   else
-    return new Ref(sym);
+    return make_node<Ref>(sym);
 }
 
 
 Expr const*
 Parser::on_def(Var const* v, Expr const* e)
 {
-  return new Def(v, e);
+  return make_node<Def>(v, e);
 }
 
 
 Expr const*
 Parser::on_abs(Var const* v, Expr const* e)
 {
-  return new Abs(v, e);
+  return make_node<Abs>(v, e);
 }
 
 
 Expr const*
 Parser::on_app(Expr const* e1, Expr const* e2)
 {
-  return new App(e1, e2);
+  return make_node<App>(e1, e2);
 }
 
 
+// The sequence is an error if either statement is ill-formed.
 Expr const*
 Parser::on_seq(Expr const* e1, Expr const* e2)
 {
-  return new Seq(e1, e2);
+  if (is_error_node(e1) || is_error_node(e2))
+    return make_error_node<Expr>();
+  return make_node<Seq>(e1, e2);
 }
 
 
@@ -8,6 +8,10 @@
 #include "ast.hpp"
 
 #include <lingo/environment.hpp>
+#include <lingo/incremental.hpp>
+#include <lingo/recovery.hpp>
+
+#include <vector>
 
 namespace calc
 {
@@ -15,28 +19,51 @@ namespace calc
 using namespace lingo;
 
 
-// Denotes a parse error.
-struct Parse_error : std::runtime_error
+// The naming environment associates names with their
+// definitions. Note that a symbol can be bound to either
+// a variable (Var) or definition (Def). Each symbol's slot
+// refers to its innermost binding, so names are resolved in
+// constant time.
+using Name_stack = Slot_stack<Var const*>;
+using Name_binding = Name_stack::Binding;
+
+
+// A top-level name used by a statement and the variable to
+// which it referred, or null if the name was unbound.
+using Name_use = std::pair<Symbol const*, Var const*>;
+
+
+// A statement saved for incremental parsing (see document.hpp).
+// A saved statement can be reused only if the names it uses
+// still refer to the same variables. Reusing the statement
+// binds the variables it defines.
+struct Statement
 {
-  using std::runtime_error::runtime_error;
+  Expr const*             expr;
+  std::vector<Name_use>   uses;
+  std::vector<Var const*> defs;
 };
 
 
-// The naming environment associates names with their
-// definitions. Note that a symbol can be bound to either
-// a variable (Var) or definition (Def).
-using Name_map = Environment<Symbol const*, Var const*>;
-using Name_binding = Name_map::Binding;
-using Name_stack = Stack<Name_map>;
+using Statement_table = Reuse_table<Statement>;
 
 
 // The parser is responsible for transforming a stream of tokens
 // into nodes. The parser owns a reference to the buffer for its
 // tokens. This supports the resolution of source code locations.
+//
+// The parser does not throw exceptions. Syntax errors are
+// diagnosed and ill-formed terms are parsed as error nodes. An
+// ill-formed statement is skipped so that parsing resumes with
+// the next.
+//
+// If a statement table is given, the parser reuses statements
+// saved by the previous parse where it can, and saves each
+// statement that it parses.
 struct Parser
 {
-  Parser(Token_stream& ts)
-    : ts_(ts)
+  Parser(Token_stream& ts, Statement_table* stmts = nullptr)
+    : ts_(ts), stmts_(stmts), stmt_(nullptr)
   { }
 
   Expr const* operator()();
@@ -49,6 +76,8 @@ struct Parser
   Expr const* primary();
   Expr const* app();
   Expr const* postfix();
+  Expr const* stmt();
+  Expr const* reuse();
   Expr const* seq();
   Expr const* binary();
   Expr const* expr();
@@ -69,8 +98,11 @@ struct Parser
   Token      require(Token_kind);
   Token      accept();
 
-  Token_stream& ts_;
-  Name_stack    names_;
+  Token_stream&    ts_;
+  Name_stack       names_;
+  Recovery         recovery_;
+  Statement_table* stmts_;
+  Statement*       stmt_;  // The statement being saved, if any
 
   // Name binding support.
   struct Environment {
@@ -6,6 +6,7 @@
 #include "parser.hpp"
 
 #include <lingo/error.hpp>
+#include <lingo/trace.hpp>
 
 namespace calc
 {
@@ -120,6 +121,7 @@ next(Expr const* e)
 Expr const*
 step_eval(Expr const* e)
 {
+  lingo_trace_scope("evaluate");
   do {
     // Reparse the input so that source locations line
     // up in each printing.
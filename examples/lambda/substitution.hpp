@@ -17,12 +17,22 @@ namespace calc
 
 // Note that the actual substitution rules are defined as
 // an application of this object as a function.
+//
+// Substitution shares structure with its input. A term in which
+// no substituted variable occurs free is returned unchanged, so
+// new nodes are allocated only along the paths from the root to
+// the replaced references.
+//
+// Substitution is capture-avoiding by construction: references
+// are resolved to the variables they name during parsing, and
+// replacement is by variable identity, not by name.
 struct Substitution : std::unordered_map<Var const*, Expr const*>
 {
   using std::unordered_map<Var const*, Expr const*>::unordered_map;
 
   Expr const* operator()(Expr const*) const;
 
+  bool        affects(Expr const*) const;
   Expr const* subst(Expr const*) const;
   Expr const* subst(Var const*) const;
   Expr const* subst(Ref const*) const;
@@ -0,0 +1,71 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+// Measures the throughput of each phase of the lambda pipeline
+// on a generated corpus (see bench/pipeline.hpp).
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "evaluator.hpp"
+
+#include <lingo/file.hpp>
+#include <lingo/error.hpp>
+
+#include <bench/pipeline.hpp>
+
+#include <memory>
+#include <stdexcept>
+
+
+using namespace lingo;
+using namespace calc;
+
+
+// Initialize the token set used by the language.
+void
+init_tokens()
+{
+  symbols.put_symbol(lparen_tok, "(");
+  symbols.put_symbol(rparen_tok, ")");
+  symbols.put_symbol(backslash_tok, "\\");
+  symbols.put_symbol(dot_tok, ".");
+  symbols.put_symbol(equal_tok, "=");
+  symbols.put_symbol(semicolon_tok, ";");
+}
+
+
+void
+translate(bench::Pipeline& p, char const* path)
+{
+  Node_factory nodes;
+  Node_factory_scope scope(nodes);
+  std::unique_ptr<File> input;
+  p.phase("load", [&]() { input.reset(new File(path)); });
+
+  Character_stream cs(*input);
+  Token_stream ts(*input);
+  Lexer lex(cs, ts);
+  p.phase("lex", [&]() { lex(); });
+  if (error_count())
+    throw std::runtime_error("lexical errors in corpus");
+  p.set_tokens(ts.buf_.size());
+
+  Parser parse(ts);
+  Expr const* expr = nullptr;
+  p.phase("parse", [&]() { expr = parse(); });
+  if (error_count())
+    throw std::runtime_error("syntax errors in corpus");
+
+  p.phase("evaluate", [&]() {
+    Evaluator eval;
+    eval(expr);
+  });
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  init_tokens();
+  return bench::run_pipeline(argc, argv, bench::lambda_lang, translate);
+}
@@ -7,93 +7,106 @@
 #include "lingo/error.hpp"
 
 #include <iostream>
-#include <set>
-#include <typeindex>
 
 namespace calc
 {
 
 // -------------------------------------------------------------------------- //
-// Ordering
-
-bool is_less(Type const*, Type const*);
+// Types
 
 
-bool
-is_less(Base_type const* a, Base_type const* b)
+// Add a new type to the table and assign its id.
+template<typename T>
+Type const*
+Type_table::insert(std::deque<T>& s, T const& t)
 {
-  std::less<Symbol const*> cmp;
-  return cmp(a->name(), b->name());
+  s.push_back(t);
+  s.back().id_ = types_.size();
+  types_.push_back(&s.back());
+  return &s.back();
 }
 
 
-bool
-is_less(Arrow_type const* a, Arrow_type const* b)
+Type const*
+Type_table::get_base_type(Symbol const* sym)
 {
-  if (is_less(a->first, b->first))
-    return true;
-  if (is_less(b->first, a->first))
-    return false;
-  return is_less(a->second, b->second);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = base_map_.find(sym);
+  if (iter != base_map_.end()) {
+    ++stats_.hits;
+    return iter->second;
+  }
+  ++stats_.misses;
+  Type const* t = insert(bases_, Base_type(sym));
+  base_map_.emplace(sym, t);
+  return t;
 }
 
 
-bool
-is_less(Type const* a, Type const* b)
+// The key of an arrow type packs the ids of its parameter
+// and result types into a single integer.
+Type const*
+Type_table::get_arrow_type(Type const* t1, Type const* t2)
 {
-  struct Fn
-  {
-    Type const* b;
-    bool operator()(Base_type const* a) const
-    {
-      return is_less(a, as<Base_type>(b));
-    }
-    bool operator()(Arrow_type const* a) const
-    {
-      return is_less(a, as<Arrow_type>(b));
-    }
-  };
-
-  std::type_index t1 = typeid(*a);
-  std::type_index t2 = typeid(*b);
-  if (t1 < t2)
-    return true;
-  if (t2 < t1)
-    return false;
-  lingo_assert(t1 == t2);
-  return apply(a, Fn{b});
+  std::uint64_t k = (std::uint64_t(t1->id()) << 32) | std::uint32_t(t2->id());
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto iter = arrow_map_.find(k);
+  if (iter != arrow_map_.end()) {
+    ++stats_.hits;
+    return iter->second;
+  }
+  ++stats_.misses;
+  Type const* t = insert(arrows_, Arrow_type(t1, t2));
+  arrow_map_.emplace(k, t);
+  return t;
 }
 
 
-// -------------------------------------------------------------------------- //
-// Types
-
-
-struct Type_less
+// Returns the global type table.
+Type_table&
+types()
 {
-  template<typename T>
-  bool operator()(T const& a, T const& b) const
-  {
-    return is_less(&a, &b);
-  }
-};
+  static Type_table tab;
+  return tab;
+}
 
 
 Type const*
 get_base_type(Symbol const* sym)
 {
-  static std::set<Base_type, Type_less> s;
-  auto iter = s.emplace(sym);
-  return &*iter.first;
+  return types().get_base_type(sym);
 }
 
 
 Type const*
 get_arrow_type(Type const* t1, Type const* t2)
 {
-  static std::set<Arrow_type, Type_less> s;
-  auto iter = s.emplace(t1, t2);
-  return &*iter.first;
+  return types().get_arrow_type(t1, t2);
+}
+
+
+// Print a summary of the type table.
+void
+print_statistics(std::ostream& os, Type_table const& t)
+{
+  os << "types: " << t.stats() << '\n';
+  os << "types: " << t.size() << " distinct types ("
+     << t.bases_.size() << " base, " << t.arrows_.size() << " arrow)\n";
+}
+
+
+// -------------------------------------------------------------------------- //
+// Node creation
+
+// Returns the current node factory, or a shared factory when no
+// factory scope is active.
+Node_factory&
+nodes()
+{
+  if (Node_factory* f = current_node_factory())
+    return *f;
+  static Node_factory f;
+  return f;
 }
 
 
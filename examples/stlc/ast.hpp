@@ -6,8 +6,17 @@
 
 #include "lingo/integer.hpp"
 #include "lingo/node.hpp"
+#include "lingo/memory.hpp"
 #include "lingo/token.hpp"
 #include "lingo/print.hpp"
+#include "lingo/cache.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 namespace calc
 {
@@ -37,14 +46,26 @@ struct Visitor;
 //
 //    t ::= x        -- uninterpreted base type
 //          t1 -> t2 -- arrow types
+//
+// Types are interned by the type table, which assigns each
+// distinct type a dense integer id. Two types are the same
+// exactly when their ids are equal.
 struct Type
 {
   struct Visitor;
 
+  Type()
+    : id_(-1)
+  { }
+
   virtual ~Type()
   { }
 
   virtual void accept(Visitor&) const = 0;
+
+  int id() const { return id_; }
+
+  int id_;
 };
 
 
@@ -87,9 +108,57 @@ struct Arrow_type : Type
 };
 
 
+// Returns true when `a` and `b` are the same type.
+inline bool
+is_same(Type const* a, Type const* b)
+{
+  return a->id() == b->id();
+}
+
+
+// The type table owns every type in the program. Base types
+// are keyed by their name and arrow types by the ids of their
+// parameter and result types, so constructing a type is a
+// single hash lookup. The ids of types are indexes into the
+// table, in the order in which the types were created.
+//
+// Types may be constructed concurrently. The accessors below
+// are not synchronized and shall not be used while types are
+// being constructed.
+struct Type_table
+{
+  Type const* get_base_type(Symbol const*);
+  Type const* get_arrow_type(Type const*, Type const*);
+
+  // Returns the type with the given id.
+  Type const* operator[](int n) const { return types_[n]; }
+
+  // Returns the number of distinct types.
+  std::size_t size() const { return types_.size(); }
+
+  // Returns the number of hits and misses in the table.
+  Cache_stats const& stats() const { return stats_; }
+
+  template<typename T>
+  Type const* insert(std::deque<T>&, T const&);
+
+  std::vector<Type const*>                       types_;
+  std::deque<Base_type>                          bases_;
+  std::deque<Arrow_type>                         arrows_;
+  std::unordered_map<Symbol const*, Type const*> base_map_;
+  std::unordered_map<std::uint64_t, Type const*> arrow_map_;
+  Cache_stats                                    stats_;
+  std::mutex                                     mutex_;
+};
+
+
+Type_table& types();
+
 Type const* get_base_type(Symbol const* n);
 Type const* get_arrow_type(Type const*, Type const*);
 
+void print_statistics(std::ostream&, Type_table const&);
+
 
 // -------------------------------------------------------------------------- //
 // Expressions
@@ -103,7 +172,7 @@ Type const* get_arrow_type(Type const*, Type const*);
 //          \x.e    -- abstractions
 //          e1 e2   -- applications
 //          e1 ; e2 -- sequences
-struct Expr
+struct Expr : Numbered_node
 {
   struct Visitor;
 
@@ -222,7 +291,7 @@ struct Decl : Expr
 struct Abs : Expr
 {
   Abs(Type const* t, Var const* v, Expr const* e)
-    : Expr({}, t), first(v), third(e)
+    : Expr({}, t), first(v), second(t), third(e)
   { }
 
   void accept(Visitor& v) const { return v.visit(this); }
@@ -231,9 +300,11 @@ struct Abs : Expr
   Type const* type() const { return second; }
   Expr const* expr() const { return third; }
 
-  Var const*  first;
-  Type const* second;
-  Expr const* third;
+  void type(Type const* t) const { Expr::type(t); second = t; }
+
+  Var const*          first;
+  mutable Type const* second;
+  Expr const*         third;
 };
 
 
@@ -321,6 +392,27 @@ apply(Expr const* e, F fn)
 }
 
 
+// -------------------------------------------------------------------------- //
+// Node creation
+
+// Terms are created by the node factory, which numbers them
+// so that analyses can save their results in side tables. Each
+// program is translated and evaluated in the scope of its own
+// factory (see main.cpp), so that the ids of its terms are dense.
+// Terms made outside of any factory scope are numbered by a
+// factory shared by the process.
+Node_factory& nodes();
+
+
+// Create a term of type T.
+template<typename T, typename... Args>
+inline T*
+make_node(Args&&... args)
+{
+  return nodes().make<T>(std::forward<Args>(args)...);
+}
+
+
 // -------------------------------------------------------------------------- //
 // Facilities
 
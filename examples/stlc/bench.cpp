@@ -0,0 +1,129 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+// Compares the performance of the tree-walking evaluator with
+// that of the bytecode compiler and virtual machine on a
+// synthetic program.
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "evaluator.hpp"
+#include "compiler.hpp"
+#include "vm.hpp"
+
+#include <lingo/io.hpp>
+#include <lingo/error.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+
+
+using namespace lingo;
+using namespace calc;
+
+
+// Initialize the token set used by the language.
+void
+init_tokens()
+{
+  symbols.put_symbol(lparen_tok, "(");
+  symbols.put_symbol(rparen_tok, ")");
+  symbols.put_symbol(backslash_tok, "\\");
+  symbols.put_symbol(dot_tok, ".");
+  symbols.put_symbol(equal_tok, "=");
+  symbols.put_symbol(colon_tok, ":");
+  symbols.put_symbol(semicolon_tok, ";");
+  symbols.put_symbol(arrow_tok, "->");
+}
+
+
+// A stream buffer that discards its output.
+struct Null_buffer : std::streambuf
+{
+  int overflow(int c) override { return c; }
+};
+
+
+// Generate a program that applies a nest of `depth` calls to
+// twice in each of `n` statements.
+String
+generate(int n, int depth)
+{
+  std::stringstream ss;
+  ss << "a : A;\n";
+  ss << "id = \\x:A.x;\n";
+  ss << "twice = \\f:A->A.\\x:A.f (f x);\n";
+  for (int i = 0; i < n; ++i) {
+    for (int j = 0; j < depth; ++j)
+      ss << "twice (";
+    ss << "id";
+    for (int j = 0; j < depth; ++j)
+      ss << ')';
+    ss << " a;\n";
+  }
+  ss << "a;\n";
+  return ss.str();
+}
+
+
+// Returns the number of milliseconds taken to call `f`.
+template<typename F>
+double
+measure(F f)
+{
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  f();
+  Clock::time_point stop = Clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+
+int
+main(int argc, char* argv[])
+{
+  init_colors();
+  init_tokens();
+
+  int n = argc > 1 ? std::atoi(argv[1]) : 1000;
+  int depth = argc > 2 ? std::atoi(argv[2]) : 8;
+  if (n <= 0 || depth <= 0) {
+    std::cerr << "usage: stlc_bench [<statements> [<depth>]]\n";
+    return -1;
+  }
+
+  Expr const* expr = parse(generate(n, depth));
+  if (is_error_node(expr)) {
+    std::cerr << "error: could not parse the benchmark program\n";
+    return 1;
+  }
+
+  // Discard the values printed by the program while timing.
+  Null_buffer null;
+  std::streambuf* out = std::cout.rdbuf(&null);
+
+  double eval_ms = measure([&]() {
+    Evaluator eval;
+    eval(expr);
+  });
+
+  Program prog;
+  double compile_ms = measure([&]() {
+    prog = compile(expr);
+  });
+
+  double vm_ms = measure([&]() {
+    Machine run(prog);
+    run();
+  });
+
+  std::cout.rdbuf(out);
+  std::cout << "statements: " << n << ", depth: " << depth << '\n';
+  std::cout << "evaluator:  " << eval_ms << " ms\n";
+  std::cout << "compiler:   " << compile_ms << " ms\n";
+  std::cout << "vm:         " << vm_ms << " ms\n";
+  return 0;
+}
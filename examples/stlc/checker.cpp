@@ -0,0 +1,277 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "checker.hpp"
+#include "parser.hpp"
+
+#include <lingo/error.hpp>
+#include <lingo/trace.hpp>
+#include <lingo/scheduler.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace calc
+{
+
+namespace
+{
+
+// -------------------------------------------------------------------------- //
+//                            Dependency analysis
+
+// Append the top-level statements of `e` to `s`. Sequences
+// are left-nested.
+void
+flatten(Expr const* e, std::vector<Expr const*>& s)
+{
+  if (Seq const* seq = as<Seq>(e)) {
+    flatten(seq->left(), s);
+    s.push_back(seq->right());
+  } else {
+    s.push_back(e);
+  }
+}
+
+
+// Records the statement binding each variable defined or
+// declared at any depth within a statement, and collects the
+// statements on which a statement depends.
+struct Binding_fn
+{
+  void operator()(Var const* e) { }
+
+  void operator()(Ref const* e)
+  {
+    auto iter = binders.find(e->var());
+    if (iter != binders.end() && iter->second != stmt)
+      deps.push_back(iter->second);
+  }
+
+  void operator()(Def const* e)
+  {
+    visit(e->expr());
+    binders.emplace(e->var(), stmt);
+  }
+
+  void operator()(Decl const* e) { binders.emplace(e->var(), stmt); }
+  void operator()(Abs const* e) { visit(e->expr()); }
+  void operator()(App const* e) { visit(e->fn()); visit(e->arg()); }
+  void operator()(Seq const* e) { visit(e->left()); visit(e->right()); }
+
+  void visit(Expr const* e) { apply(e, *this); }
+
+  std::unordered_map<Var const*, int>& binders;
+  std::vector<int>&                    deps;
+  int                                  stmt;
+};
+
+
+// -------------------------------------------------------------------------- //
+//                            Type checking
+
+// The state of a statement during checking.
+struct Statement
+{
+  std::atomic<int>  waiting; // Unchecked dependencies
+  std::atomic<bool> failed;  // True if not well-typed
+  Location          loc;     // The location of the error
+  String            msg;     // The error message
+};
+
+
+// The type checker assigns types to the terms of a single
+// statement. The first error is recorded in the statement and
+// the checker stops by throwing a type error.
+struct Type_checker
+{
+  Type const* operator()(Var const* e) { return e->type(); }
+
+  Type const* operator()(Ref const* e)
+  {
+    Type const* t = e->var()->type();
+    e->type(t);
+    return t;
+  }
+
+  Type const* operator()(Def const* e)
+  {
+    Type const* t = check(e->expr());
+    e->var()->type(t);
+    e->type(t);
+    return t;
+  }
+
+  Type const* operator()(Decl const* e) { return e->var()->type(); }
+
+  // G |- v:T1 ; G, v:T1 |- e : T2
+  // ----------------------------
+  //    G |- \v.e : T1 -> T2
+  Type const* operator()(Abs const* e)
+  {
+    Type const* t = get_arrow_type(e->var()->type(), check(e->expr()));
+    e->type(t);
+    return t;
+  }
+
+  // G |- e1 : T1 -> T2 ; G |- e2 : T1
+  // ---------------------------------
+  //        G |- e1 e2 : T2
+  //
+  // The function and argument are checked before the
+  // application, as they are when checking during parsing.
+  Type const* operator()(App const* e)
+  {
+    Type const* t1 = check(e->fn());
+    Type const* t2 = check(e->arg());
+    Arrow_type const* a = as<Arrow_type>(t1);
+    if (!a)
+      fail(e, "expression does not have arrow type");
+    if (!is_same(t2, a->in()))
+      fail(e, "type mismatch in application");
+    e->type(a->out());
+    return a->out();
+  }
+
+  // Types are ignored.
+  Type const* operator()(Seq const* e)
+  {
+    check(e->left());
+    return check(e->right());
+  }
+
+  Type const* check(Expr const* e) { return apply(e, *this); }
+
+  [[noreturn]] void fail(Expr const* e, char const* msg)
+  {
+    stmt.loc = e->location();
+    stmt.msg = msg;
+    throw Type_error();
+  }
+
+  Statement& stmt;
+};
+
+
+// Check the statement `e`. Returns false if it is ill-typed.
+bool
+check_statement(Expr const* e, Statement& s)
+{
+  lingo_trace_scope("check");
+  Type_checker tc{s};
+  try {
+    tc.check(e);
+    return true;
+  } catch (Type_error&) {
+    return false;
+  }
+}
+
+
+// Check the statements of `g` concurrently. A statement is
+// spawned when its last dependency has been checked. The
+// global scheduler is used when it provides the requested
+// concurrency. Otherwise, a scheduler is created for the check.
+void
+check_parallel(Dependency_graph const& g, std::vector<Statement>& s, int n)
+{
+  std::unique_ptr<Scheduler> local;
+  Scheduler* sched = &scheduler();
+  if (sched->concurrency() != n) {
+    local.reset(new Scheduler(n - 1));
+    sched = local.get();
+  }
+
+  Task_group group(*sched);
+  std::function<void(int)> run = [&](int i) {
+    if (!s[i].failed && !check_statement(g.stmts[i], s[i]))
+      s[i].failed = true;
+    for (int u : g.users[i]) {
+      if (s[i].failed)
+        s[u].failed = true;
+      if (--s[u].waiting == 0)
+        group.spawn([&run, u]() { run(u); });
+    }
+  };
+  for (std::size_t i = 0; i < g.stmts.size(); ++i) {
+    if (g.deps[i].empty())
+      group.spawn([&run, i]() { run(i); });
+  }
+  group.sync();
+}
+
+
+// Check the statements of `g` in source order.
+void
+check_sequential(Dependency_graph const& g, std::vector<Statement>& s)
+{
+  for (std::size_t i = 0; i < g.stmts.size(); ++i) {
+    if (!s[i].failed && !check_statement(g.stmts[i], s[i]))
+      s[i].failed = true;
+    if (s[i].failed) {
+      for (int u : g.users[i])
+        s[u].failed = true;
+    }
+  }
+}
+
+
+} // namespace
+
+
+// Build the dependency graph of the top-level statements
+// of `e`.
+Dependency_graph
+analyze(Expr const* e)
+{
+  Dependency_graph g;
+  flatten(e, g.stmts);
+  g.deps.resize(g.stmts.size());
+  g.users.resize(g.stmts.size());
+  std::unordered_map<Var const*, int> binders;
+  for (std::size_t i = 0; i < g.stmts.size(); ++i) {
+    std::vector<int>& d = g.deps[i];
+    Binding_fn fn{binders, d, int(i)};
+    fn.visit(g.stmts[i]);
+    std::sort(d.begin(), d.end());
+    d.erase(std::unique(d.begin(), d.end()), d.end());
+    for (int j : d)
+      g.users[j].push_back(i);
+  }
+  return g;
+}
+
+
+// Type check the program `e`, whose checking was deferred by
+// the parser, using `n` threads. Returns true if the program is
+// well-typed. Otherwise, errors are diagnosed in source order.
+bool
+check(Expr const* e, int n)
+{
+  Dependency_graph g = analyze(e);
+  std::vector<Statement> s(g.stmts.size());
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    s[i].waiting = g.deps[i].size();
+    s[i].failed = false;
+  }
+
+  if (n > 1)
+    check_parallel(g, s, n);
+  else
+    check_sequential(g, s);
+
+  bool ok = true;
+  for (Statement const& stmt : s) {
+    if (!stmt.msg.empty()) {
+      error(stmt.loc, stmt.msg);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+
+} // namespace calc
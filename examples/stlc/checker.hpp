@@ -0,0 +1,50 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef CALC_CHECKER_HPP
+#define CALC_CHECKER_HPP
+
+// The checker assigns types to programs whose checking was
+// deferred by the parser.
+//
+// A program is a sequence of top-level statements. A statement
+// depends on each earlier statement that binds a variable to
+// which it refers. Statements that do not depend on each other,
+// directly or indirectly, are checked concurrently. Note that a
+// declaration has no dependencies since its type is written
+// explicitly.
+//
+// Each statement is checked until its first type error. Errors
+// are reported in source order once checking is complete, and
+// statements that depend on an ill-typed statement are not
+// checked.
+
+#include "ast.hpp"
+
+#include <vector>
+
+namespace calc
+{
+
+using namespace lingo;
+
+
+// The dependency graph of a program's top-level statements.
+// Statements are numbered in source order, so each statement
+// depends only on statements with smaller numbers.
+struct Dependency_graph
+{
+  std::vector<Expr const*>      stmts; // Top-level statements
+  std::vector<std::vector<int>> deps;  // Statements each depends on
+  std::vector<std::vector<int>> users; // Statements depending on each
+};
+
+
+Dependency_graph analyze(Expr const*);
+
+bool check(Expr const*, int = 1);
+
+
+} // namespace calc
+
+#endif
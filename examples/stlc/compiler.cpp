@@ -0,0 +1,294 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "compiler.hpp"
+#include "free.hpp"
+
+#include <lingo/error.hpp>
+#include <lingo/trace.hpp>
+
+#include <iostream>
+#include <unordered_map>
+
+namespace calc
+{
+
+namespace
+{
+
+// The compiler maintains the slot assignments of the program
+// being compiled. Code is generated into functions by index
+// since the function table grows during compilation.
+struct Compiler
+{
+  Compiler(Program& p)
+    : prog(p)
+  { }
+
+  void        declare(Expr const*);
+  int         function(Abs const*, Var_set const&);
+  Type const* expr(int, Expr const*);
+  void        load(int, Var const*);
+  void        emit(int, Opcode, int = 0);
+  int         type(Type const*);
+
+  Program&                             prog;
+  std::unordered_map<Var const*, int>  globals;
+  std::unordered_map<Var const*, int>  constants;
+  std::unordered_map<Type const*, int> types;
+};
+
+
+// Assign a slot to each variable introduced by a definition or
+// declaration in `e`. Definitions are global regardless of where
+// they appear (see Evaluator::eval(Def const*)).
+void
+Compiler::declare(Expr const* e)
+{
+  struct Fn
+  {
+    Compiler& c;
+    void operator()(Var const* e) { }
+    void operator()(Ref const* e) { }
+
+    void operator()(Def const* e)
+    {
+      c.globals.emplace(e->var(), c.prog.globals.size());
+      c.prog.globals.push_back(e->var());
+      c.declare(e->expr());
+    }
+
+    void operator()(Decl const* e)
+    {
+      c.constants.emplace(e->var(), c.prog.constants.size());
+      c.prog.constants.push_back(e->var());
+    }
+
+    void operator()(Abs const* e) { c.declare(e->expr()); }
+    void operator()(App const* e) { c.declare(e->fn()); c.declare(e->arg()); }
+    void operator()(Seq const* e) { c.declare(e->left()); c.declare(e->right()); }
+  };
+  apply(e, Fn{*this});
+}
+
+
+// Closure convert the abstraction `e`, returning the index of the
+// new function. The captures are the free variables of `e` that
+// are neither globals nor constants.
+int
+Compiler::function(Abs const* e, Var_set const& fv)
+{
+  int n = prog.functions.size();
+  prog.functions.push_back(Function{e, e->var()->type(), {}, {}});
+  for (Var const* v : fv) {
+    if (!globals.count(v) && !constants.count(v))
+      prog.functions[n].captures.push_back(v);
+  }
+  expr(n, e->expr());
+  emit(n, return_op);
+  return n;
+}
+
+
+// Generate code that pushes the value of `v` in function `f`.
+void
+Compiler::load(int f, Var const* v)
+{
+  Function const& fn = prog.functions[f];
+  if (fn.abs && fn.abs->var() == v)
+    return emit(f, local_op);
+  for (std::size_t i = 0; i < fn.captures.size(); ++i) {
+    if (fn.captures[i] == v)
+      return emit(f, capture_op, i);
+  }
+  auto g = globals.find(v);
+  if (g != globals.end())
+    return emit(f, global_op, g->second);
+  auto c = constants.find(v);
+  if (c != constants.end())
+    return emit(f, constant_op, c->second);
+  lingo_unreachable("unbound variable '{}'", *v->name());
+}
+
+
+// Generate code for `e` in function `f`. Returns the type of
+// the value pushed by that code, or null if no value is pushed.
+Type const*
+Compiler::expr(int f, Expr const* e)
+{
+  struct Fn
+  {
+    Compiler& c;
+    int       f;
+
+    // Variables are never evaluated.
+    Type const* operator()(Var const* e)
+    {
+      lingo_unreachable("evaluation of variable");
+    }
+
+    Type const* operator()(Ref const* e)
+    {
+      c.load(f, e->var());
+      return e->var()->type();
+    }
+
+    Type const* operator()(Def const* e)
+    {
+      c.expr(f, e->expr());
+      c.emit(f, define_op, c.globals[e->var()]);
+      return nullptr;
+    }
+
+    Type const* operator()(Decl const* e)
+    {
+      return nullptr;
+    }
+
+    // Push the captured values and build the closure.
+    Type const* operator()(Abs const* e)
+    {
+      int g = c.function(e, free_vars(e));
+      for (Var const* v : c.prog.functions[g].captures)
+        c.load(f, v);
+      c.emit(f, closure_op, g);
+      return e->Expr::type();
+    }
+
+    Type const* operator()(App const* e)
+    {
+      c.expr(f, e->fn());
+      c.expr(f, e->arg());
+      c.emit(f, apply_op);
+      return e->type();
+    }
+
+    // As with the evaluator, the value of the left operand
+    // (if any) is printed.
+    Type const* operator()(Seq const* e)
+    {
+      if (Type const* t = c.expr(f, e->left()))
+        c.emit(f, print_op, c.type(t));
+      return c.expr(f, e->right());
+    }
+  };
+  return apply(e, Fn{*this, f});
+}
+
+
+void
+Compiler::emit(int f, Opcode op, int n)
+{
+  prog.functions[f].code.push_back({op, n});
+}
+
+
+// Returns the index of `t` in the program's type table.
+int
+Compiler::type(Type const* t)
+{
+  auto ins = types.emplace(t, prog.types.size());
+  if (ins.second)
+    prog.types.push_back(t);
+  return ins.first->second;
+}
+
+
+} // namespace
+
+
+// Compile the program `e`. The program shall be well-typed.
+Program
+compile(Expr const* e)
+{
+  lingo_trace_scope("compile");
+  Program prog;
+  Compiler comp(prog);
+  comp.declare(e);
+  prog.functions.push_back(Function{nullptr, nullptr, {}, {}});
+  prog.result = comp.expr(0, e);
+  comp.emit(0, return_op);
+  return prog;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Printing
+
+namespace
+{
+
+char const*
+get_name(Opcode op)
+{
+  switch (op) {
+    case local_op: return "local";
+    case capture_op: return "capture";
+    case global_op: return "global";
+    case constant_op: return "constant";
+    case closure_op: return "closure";
+    case apply_op: return "apply";
+    case define_op: return "define";
+    case print_op: return "print";
+    case return_op: return "return";
+  }
+  lingo_unreachable();
+}
+
+
+} // namespace
+
+
+void
+print(std::ostream& os, Instr i)
+{
+  os << get_name(i.op);
+  switch (i.op) {
+    case capture_op:
+    case global_op:
+    case constant_op:
+    case closure_op:
+    case define_op:
+    case print_op:
+      os << ' ' << i.arg;
+      break;
+    default:
+      break;
+  }
+}
+
+
+// Print a listing of the program.
+void
+print(std::ostream& os, Program const& p)
+{
+  for (std::size_t i = 0; i < p.globals.size(); ++i)
+    os << "global " << i << ": " << *p.globals[i] << '\n';
+  for (std::size_t i = 0; i < p.constants.size(); ++i)
+    os << "constant " << i << ": " << *p.constants[i] << '\n';
+  for (std::size_t i = 0; i < p.functions.size(); ++i) {
+    Function const& fn = p.functions[i];
+    os << "function " << i;
+    if (fn.abs)
+      os << " (" << *fn.abs->var() << ')';
+    os << ":\n";
+    for (std::size_t j = 0; j < fn.captures.size(); ++j)
+      os << "  ; capture " << j << ": " << *fn.captures[j] << '\n';
+    for (Instr instr : fn.code) {
+      os << "  ";
+      print(os, instr);
+      os << '\n';
+    }
+  }
+}
+
+
+std::ostream&
+operator<<(std::ostream& os, Program const& p)
+{
+  print(os, p);
+  return os;
+}
+
+
+} // namespace calc
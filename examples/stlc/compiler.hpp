@@ -0,0 +1,101 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef CALC_COMPILER_HPP
+#define CALC_COMPILER_HPP
+
+// The compiler lowers well-typed terms into a flat bytecode
+// for execution by the virtual machine (see vm.hpp).
+//
+// Each abstraction is closure converted into a function that
+// takes a single parameter and refers to the variables it
+// captures by index. Definitions become global slots and
+// declarations become constants. The top-level program is
+// compiled into a function with no parameter.
+//
+// Because the program has been type checked, the type of every
+// slot is known statically. The compiler records those types so
+// that the machine can represent values without tags: a value
+// of arrow type is always a closure, and a value of base type
+// is always a declared constant.
+
+#include "ast.hpp"
+
+#include <iosfwd>
+#include <vector>
+
+namespace calc
+{
+
+using namespace lingo;
+
+
+// -------------------------------------------------------------------------- //
+//                            Instructions
+
+enum Opcode
+{
+  local_op,    // Push the parameter
+  capture_op,  // Push the captured value n
+  global_op,   // Push the value of global n
+  constant_op, // Push constant n
+  closure_op,  // Pop the captures of function n and push a closure
+  apply_op,    // Pop an argument and a closure, and call it
+  define_op,   // Pop a value into global n
+  print_op,    // Pop a value and print it with type n
+  return_op,   // Return from the current function
+};
+
+
+// An instruction is an opcode and its immediate operand.
+struct Instr
+{
+  Opcode op;
+  int    arg;
+};
+
+
+// A function is the code for a closure converted abstraction.
+// The captures are the variables free in the abstraction that
+// are bound by enclosing abstractions, in the order in which
+// they are stored in a closure.
+struct Function
+{
+  Abs const*              abs;      // The source abstraction
+  Type const*             param;    // The type of the parameter
+  std::vector<Var const*> captures; // Captured variables
+  std::vector<Instr>      code;
+};
+
+
+// A compiled program. Function 0 is the top-level program.
+// The globals and constants tables map slot numbers back to
+// their variables, whose types are the types of the slots.
+//
+// The result type is the type of the program's value, or
+// null if evaluating the program produces no value.
+struct Program
+{
+  std::vector<Function>    functions;
+  std::vector<Var const*>  globals;
+  std::vector<Var const*>  constants;
+  std::vector<Type const*> types;
+  Type const*              result;
+};
+
+
+Program compile(Expr const*);
+
+
+// -------------------------------------------------------------------------- //
+//                            Facilities
+
+void print(std::ostream&, Instr);
+void print(std::ostream&, Program const&);
+
+std::ostream& operator<<(std::ostream&, Program const&);
+
+
+} // namespace calc
+
+#endif
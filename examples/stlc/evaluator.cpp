@@ -3,6 +3,9 @@
 
 #include "evaluator.hpp"
 #include "substitution.hpp"
+#include "memo.hpp"
+
+#include <lingo/trace.hpp>
 
 #include <iostream>
 #include <stdexcept>
@@ -13,6 +16,7 @@ namespace calc
 Expr const*
 Evaluator::operator()(Expr const* e)
 {
+  lingo_trace_scope("evaluate");
   return eval(e);
 }
 
@@ -110,6 +114,11 @@ Evaluator::eval(App const* e)
   }
   Expr const* arg = eval(e->arg());
 
+  // Reuse the result of an equivalent application.
+  if (memo_)
+    if (Expr const* result = memo_->get(fn, arg))
+      return result;
+
   // Sbustitute the argument into the abstraction.
   Substitution subst {
     {fn->var(), arg}
@@ -117,7 +126,10 @@ Evaluator::eval(App const* e)
   Expr const* result = subst(fn->expr());
 
   // And recursively evaluate.
-  return eval(result);
+  result = eval(result);
+  if (memo_)
+    memo_->put(fn, arg, result);
+  return result;
 }
 
 
@@ -0,0 +1,122 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "free.hpp"
+
+#include <lingo/analysis.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+
+namespace calc
+{
+
+namespace
+{
+
+Var_set compute(Expr const*);
+
+
+// The free variables of each term are computed once and
+// cached. Terms are immutable and never deallocated, so
+// the cached sets remain valid. The sets are indexed by node
+// id, so they are discarded when terms are made by another
+// node factory (i.e., when another program is evaluated).
+Analysis<Expr, Var_set> free_(compute);
+std::uint64_t           owner_ = 0; // The factory of the cached terms
+
+
+// Returns the union of `a` and `b`.
+Var_set
+join(Var_set const& a, Var_set const& b)
+{
+  if (a.empty())
+    return b;
+  if (b.empty())
+    return a;
+  Var_set s;
+  s.reserve(a.size() + b.size());
+  std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(s));
+  return s;
+}
+
+
+// Returns `a` without `v`.
+Var_set
+remove(Var_set const& a, Var const* v)
+{
+  Var_set s = a;
+  auto iter = std::lower_bound(s.begin(), s.end(), v);
+  if (iter != s.end() && *iter == v)
+    s.erase(iter);
+  return s;
+}
+
+
+// Compute the free variables of a term from those of its
+// subterms.
+//
+//    FV(x)       = {}
+//    FV(ref x)   = {x}
+//    FV(x = e)   = FV(e)
+//    FV(x : t)   = {}
+//    FV(\x.e)    = FV(e) - {x}
+//    FV(e1 e2)   = FV(e1) U FV(e2)
+//    FV(e1 ; e2) = FV(e1) U FV(e2)
+//
+// Unresolved references name no variable, and are never
+// free. Note that the variables introduced by definitions
+// are not removed from the sequences in which they are
+// defined. This over-approximates the free set, which is
+// safe for substitution.
+Var_set
+compute(Expr const* e)
+{
+  struct Fn
+  {
+    Var_set operator()(Var const* e) { return {}; }
+
+    Var_set operator()(Ref const* e)
+    {
+      if (e->var())
+        return {e->var()};
+      return {};
+    }
+
+    Var_set operator()(Def const* e) { return free_vars(e->expr()); }
+    Var_set operator()(Decl const* e) { return {}; }
+    Var_set operator()(Abs const* e) { return remove(free_vars(e->expr()), e->var()); }
+    Var_set operator()(App const* e) { return join(free_vars(e->fn()), free_vars(e->arg())); }
+    Var_set operator()(Seq const* e) { return join(free_vars(e->left()), free_vars(e->right())); }
+  };
+  return apply(e, Fn{});
+}
+
+
+} // namespace
+
+
+// Returns the set of variables that occur free in `e`.
+Var_set const&
+free_vars(Expr const* e)
+{
+  std::uint64_t f = nodes().id();
+  if (f != owner_) {
+    free_.clear();
+    owner_ = f;
+  }
+  return free_(e);
+}
+
+
+// Returns true if `v` occurs free in `e`.
+bool
+occurs_free(Var const* v, Expr const* e)
+{
+  Var_set const& s = free_vars(e);
+  return std::binary_search(s.begin(), s.end(), v);
+}
+
+
+} // namespace calc
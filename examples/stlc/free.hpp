@@ -0,0 +1,29 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef CALC_FREE_HPP
+#define CALC_FREE_HPP
+
+// The free module computes the sets of variables that
+// occur free in terms.
+
+#include "ast.hpp"
+
+#include <vector>
+
+namespace calc
+{
+
+
+// A set of variables, represented as a vector sorted by
+// address.
+using Var_set = std::vector<Var const*>;
+
+
+Var_set const& free_vars(Expr const*);
+bool           occurs_free(Var const*, Expr const*);
+
+
+} // namespace calc
+
+#endif
@@ -4,6 +4,7 @@
 #include "lexer.hpp"
 
 #include <lingo/error.hpp>
+#include <lingo/trace.hpp>
 
 #include <cassert>
 #include <cctype>
@@ -187,6 +188,7 @@ Lexer::on_integer()
 void
 Lexer::operator()()
 {
+  lingo_trace_scope("lex");
   while (Token tok = scan())
     ts_.put(tok);
 }
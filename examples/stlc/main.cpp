@@ -4,12 +4,26 @@
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "evaluator.hpp"
+#include "memo.hpp"
+#include "checker.hpp"
+#include "compiler.hpp"
+#include "vm.hpp"
 
 #include <lingo/file.hpp>
+#include <lingo/driver.hpp>
 #include <lingo/io.hpp>
 #include <lingo/error.hpp>
+#include <lingo/trace.hpp>
+#include <lingo/accounting.hpp>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 
 using namespace lingo;
@@ -31,41 +45,161 @@ init_tokens()
 }
 
 
-int
-main(int argc, char* argv[])
+// A translated program. Its terms are numbered by its own node
+// factory, which also numbers the terms made by evaluating it.
+struct Translation
 {
-  init_colors();
-  init_tokens();
+  Expr const*                   expr;
+  std::unique_ptr<Node_factory> nodes;
+};
 
-  if (argc != 2) {
-    std::cerr << "usage: lambda <input-file>\n";
-    return -1;
-  }
 
-  File input(argv[1]);
+// Lex, parse, and type check the file. The expression is null
+// if the program is ill-formed. Statements are type checked using
+// `threads` threads, or while parsing if that is 0.
+Translation
+translate(File& input, int threads)
+{
+  Translation t {nullptr, std::unique_ptr<Node_factory>(new Node_factory())};
+  Node_factory_scope scope(*t.nodes);
   Character_stream cs(input);
   Token_stream ts(input);
   Lexer lex(cs, ts);
-  Parser parse(ts);
+  Parser parse(ts, threads == 0);
 
   // Transform characters into tokens.
   lex();
   if (error_count())
-    return -1;
+    return t;
+
+  // Transform tokens into abstract syntax. Ill-formed statements
+  // are omitted from the program, and deferred checking runs over
+  // the others, so that their type errors are diagnosed as they
+  // are when checking while parsing.
+  Expr const* expr = parse();
+  if (threads && is_valid_node(expr))
+    check(expr, threads);
+  if (!error_count())
+    t.expr = expr;
+  return t;
+}
+
+
+// Print the program usage.
+int
+usage()
+{
+  std::cerr << "usage: stlc [--memo[=<n>] | --vm | --bytecode] [--types] [--memory] [--parallel[=<n>]] [--trace[-counters]=<file>] <input-file>...\n";
+  return -1;
+}
 
+
+int
+main(int argc, char* argv[])
+{
+  init_colors();
+  init_tokens();
+
+  // Process command line options. The --memo option enables
+  // memoization of applications, optionally limiting the
+  // number of memoized results. The --vm option compiles the
+  // program and runs it on the virtual machine, and the
+  // --bytecode option prints the compiled program. The --types
+  // option prints statistics about the type table, and the
+  // --memory option prints the memory used by lingo. The --parallel
+  // option type checks independent top-level statements using
+  // the given number of threads (by default, one per core). The
+  // --trace option records the time spent in each phase and
+  // writes it to the given file in the Chrome trace event format,
+  // and the --trace-counters option also records hardware
+  // counters for each phase. At most one of --memo, --vm, and
+  // --bytecode may be given.
+  //
+  // Each input file is a separate program. Files are translated
+  // in parallel and then evaluated in the order given. Each
+  // program has its own memo table, since the tables are indexed
+  // by the ids of the program's terms.
+  std::vector<std::string> paths;
+  std::size_t memo = 0;
+  bool vm = false;
+  bool bytecode = false;
+  bool stats = false;
+  bool memory = false;
+  int threads = 0;
+  std::unique_ptr<Trace_file> trace;
+  for (int i = 1; i < argc; ++i) {
+    char const* arg = argv[i];
+    if (std::strcmp(arg, "--vm") == 0)
+      vm = true;
+    else if (std::strcmp(arg, "--bytecode") == 0)
+      bytecode = true;
+    else if (std::strcmp(arg, "--types") == 0)
+      stats = true;
+    else if (std::strcmp(arg, "--memory") == 0)
+      memory = true;
+    else if (std::strcmp(arg, "--parallel") == 0)
+      threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+    else if (std::strncmp(arg, "--parallel=", 11) == 0 && std::atoi(arg + 11) > 0)
+      threads = std::atoi(arg + 11);
+    else if (std::strcmp(arg, "--memo") == 0)
+      memo = Memo_table::default_capacity;
+    else if (std::strncmp(arg, "--memo=", 7) == 0 && std::atoi(arg + 7) > 0)
+      memo = std::atoi(arg + 7);
+    else if (std::strncmp(arg, "--trace=", 8) == 0)
+      trace.reset(new Trace_file(arg + 8));
+    else if (std::strncmp(arg, "--trace-counters=", 17) == 0)
+      trace.reset(new Trace_file(arg + 17, true));
+    else if (arg[0] != '-')
+      paths.push_back(arg);
+    else
+      return usage();
+  }
+  if (paths.empty())
+    return usage();
+  if ((memo != 0) + vm + bytecode > 1)
+    return usage();
+
+  std::vector<File_result<Translation>> files = process_files(paths, [threads](File& f) {
+    return translate(f, threads);
+  });
+  if (report_diagnostics(files))
+    return 1;
+  if (stats)
+    print_statistics(std::cerr, types());
+
+  std::vector<std::unique_ptr<Memo_table>> memos;
   try {
-    // Transform tokens into abstract syntax.
-    Expr const* expr = parse();
-    if (error_count())
-      return 1;
-    // std::cout << "Parsed:\n" << *expr << '\n';
-
-    Evaluator eval;
-    Expr const* result = eval(expr);
-    if (result)
-      std::cout << *result << '\n';
+    for (File_result<Translation> const& f : files) {
+      Node_factory_scope scope(*f.result.nodes);
+      Expr const* expr = f.result.expr;
+      // std::cout << "Parsed:\n" << *expr << '\n';
+
+      // Well-typed programs can be compiled and executed on
+      // the virtual machine.
+      if (vm || bytecode) {
+        Program prog = compile(expr);
+        if (bytecode) {
+          std::cout << prog;
+          continue;
+        }
+        Machine run(prog);
+        if (Expr const* result = run())
+          std::cout << *result << '\n';
+      } else {
+        if (memo)
+          memos.emplace_back(new Memo_table(memo));
+        Evaluator eval(memo ? memos.back().get() : nullptr);
+        Expr const* result = eval(expr);
+        if (result)
+          std::cout << *result << '\n';
+      }
+    }
   } catch (Translation_error&) {
     return 1;
   }
+  for (std::unique_ptr<Memo_table> const& m : memos)
+    print_statistics(std::cerr, *m);
+  if (memory)
+    report_memory_usage(std::cerr);
   return 0;
 }
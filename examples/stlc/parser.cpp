@@ -6,6 +6,8 @@
 #include "ast.hpp"
 
 #include <lingo/error.hpp>
+#include <lingo/node.hpp>
+#include <lingo/trace.hpp>
 
 #include <iostream>
 
@@ -30,6 +32,10 @@ token_spelling(Token_stream& ts)
 }
 
 
+// Parsing resumes at the next statement after a syntax error.
+constexpr Token_set stmt_sync {semicolon_tok};
+
+
 } // namespace
 
 
@@ -49,6 +55,9 @@ Parser::lookahead(int n) const
 }
 
 
+// If the current token matches k, return the token and
+// advance the stream. Otherwise, diagnose the error and
+// return an invalid token.
 Token
 Parser::match(Token_kind k)
 {
@@ -58,8 +67,8 @@ Parser::match(Token_kind k)
   String msg = format("expected '{}' but got '{}'",
                       get_spelling(k),
                       token_spelling(ts_));
-  error(ts_.location(), msg);
-  throw Parse_error();
+  recovery_.error(ts_.location(), msg);
+  return Token();
 }
 
 
@@ -105,9 +114,10 @@ Type const*
 Parser::paren_type()
 {
   require(lparen_tok);
-  Type const* t = type();
-  match(rparen_tok);
-  return t;
+  Required<Type> t = type();
+  if (!t || !match(rparen_tok))
+    return make_error_node<Type>();
+  return *t;
 }
 
 // primary-type: base-type
@@ -119,8 +129,8 @@ Parser::primary_type()
     return on_base_type(tok);
   if (lookahead() == lparen_tok)
     return paren_type();
-  error(ts_.location(), "expected primary-type");
-  throw Parse_error();
+  recovery_.error(ts_.location(), "expected primary-type");
+  return make_error_node<Type>();
 }
 
 
@@ -129,10 +139,16 @@ Parser::primary_type()
 Type const*
 Parser::arrow_type()
 {
-  Type const* t = primary_type();
-  if (match_if(arrow_tok))
-    t = on_arrow_type(t, arrow_type());
-  return t;
+  Required<Type> t1 = primary_type();
+  if (!t1)
+    return make_error_node<Type>();
+  if (match_if(arrow_tok)) {
+    Required<Type> t2 = arrow_type();
+    if (!t2)
+      return make_error_node<Type>();
+    return on_arrow_type(*t1, *t2);
+  }
+  return *t1;
 }
 
 
@@ -147,13 +163,23 @@ Parser::type()
 // Expression parsing
 
 // var: id ':' type
+//
+// If the variable is ill-formed, its name is bound to an
+// error node so that its uses are not diagnosed again.
 Var const*
 Parser::var()
 {
-  Token n = require(identifier_tok);
-  match(colon_tok);
-  Type const* t = type();
-  return on_var(n, t);
+  Token n = match(identifier_tok);
+  if (!n)
+    return make_error_node<Var>();
+  Required<Type> t;
+  if (match(colon_tok))
+    t = type();
+  if (!t) {
+    names_.bind(n.symbol(), make_error_node<Var>());
+    return make_error_node<Var>();
+  }
+  return on_var(n, *t);
 }
 
 
@@ -167,14 +193,21 @@ Parser::id()
 
 // def: id '=' expr
 //
+// If the definition is ill-formed, the name is bound to an
+// error node so that its uses are not diagnosed again.
+//
 // TODO: Allow explicit specification of types?
 Expr const*
 Parser::def()
 {
   Token n = require(identifier_tok);
-  match(equal_tok);
-  Expr const* e = expr();
-  return on_def(n, e);
+  require(equal_tok);
+  Required<Expr> e = expr();
+  if (!e) {
+    names_.bind(n.symbol(), make_error_node<Var>());
+    return make_error_node<Expr>();
+  }
+  return on_def(n, *e);
 }
 
 
@@ -182,8 +215,10 @@ Parser::def()
 Expr const*
 Parser::decl()
 {
-  Var const* v = var();
-  return on_decl(v);
+  Required<Var> v = var();
+  if (!v)
+    return make_error_node<Expr>();
+  return on_decl(*v);
 }
 
 
@@ -192,10 +227,13 @@ Parser::abs()
 {
   Environment env(*this);
   require(backslash_tok);
-  Var const* v = var();
-  match(dot_tok);
-  Expr const* e = expr();
-  return on_abs(v, e);
+  Required<Var> v = var();
+  if (!v || !match(dot_tok))
+    return make_error_node<Expr>();
+  Required<Expr> e = expr();
+  if (!e)
+    return make_error_node<Expr>();
+  return on_abs(*v, *e);
 }
 
 
@@ -203,9 +241,10 @@ Expr const*
 Parser::paren()
 {
   require(lparen_tok);
-  Expr const* e = expr();
-  match(rparen_tok);
-  return e;
+  Required<Expr> e = expr();
+  if (!e || !match(rparen_tok))
+    return make_error_node<Expr>();
+  return *e;
 }
 
 
@@ -233,26 +272,34 @@ Parser::primary()
     return abs();
   if (lookahead() == lparen_tok)
     return paren();
-  error(ts_.location(), "expected primary-expression");
-  throw Parse_error();
+  recovery_.error(ts_.location(), "expected primary-expression");
+  return make_error_node<Expr>();
 }
 
 
 Expr const*
 Parser::postfix()
 {
-  Expr const* e = primary();
+  Required<Expr> e1 = primary();
+  if (!e1)
+    return make_error_node<Expr>();
   while (true) {
     // We have an application only when the lookahead
     // indicates the start of a new primary expression.
     if (lookahead() == identifier_tok ||
         lookahead() == backslash_tok ||
-        lookahead() == lparen_tok)
-      e = on_app(e, primary());
+        lookahead() == lparen_tok) {
+      Required<Expr> e2 = primary();
+      if (!e2)
+        return make_error_node<Expr>();
+      e1 = on_app(*e1, *e2);
+      if (!e1)
+        return make_error_node<Expr>();
+    }
     else
       break;
   }
-  return e;
+  return *e1;
 }
 
 
@@ -263,19 +310,39 @@ Parser::expr()
 }
 
 
-// seq: seq ';' expr
-//      expr [;]
+// stmt: expr
+//
+// A statement is followed by a semicolon or the end of input.
+// If the statement is ill-formed, the parser skips to the next
+// semicolon, so that parsing resumes with the next statement.
+Expr const*
+Parser::stmt()
+{
+  Required<Expr> e = expr();
+  if (e && !ts_.eof() && lookahead() != semicolon_tok) {
+    String msg = format("expected ';' but got '{}'", token_spelling(ts_));
+    recovery_.error(ts_.location(), msg);
+    e = make_error_node<Expr>();
+  }
+  if (!e)
+    recovery_.synchronize(ts_, stmt_sync);
+  return *e;
+}
+
+
+// seq: seq ';' stmt
+//      stmt [;]
 //
 // We allow a trailing semicolon for convenience.
 Expr const*
 Parser::seq()
 {
-  Expr const* e = postfix();
+  Expr const* e = stmt();
   while (true) {
     if (match_if(semicolon_tok)) {
       if (ts_.eof())
         return e;
-      e = on_seq(e, expr());
+      e = on_seq(e, stmt());
     }
     else
       break;
@@ -287,16 +354,11 @@ Parser::seq()
 Expr const*
 Parser::operator()()
 {
+  lingo_trace_scope("parse");
   Environment env(*this);
   if (ts_.eof())
     return nullptr;
-  Expr const* e = seq();
-  if (!ts_.eof()) {
-    String msg = format("expected end-of-input but got '{}'", ts_.peek());
-    error(ts_.location(), msg);
-    throw Parse_error();
-  }
-  return e;
+  return seq();
 }
 
 
@@ -322,22 +384,26 @@ Var const*
 Parser::on_var(Token tok, Type const* t)
 {
   Symbol const* sym = tok.symbol();
-  Var* v = new Var(sym, t);
+  Var* v = make_node<Var>(sym, t);
   names_.bind(sym, v);
   return v;
 }
 
 
-// Return a reference to the bound variable (if bound)
-// or simply the symbol (if unbound).
+// Return a reference to the bound variable. If the name
+// is unbound, or bound by an ill-formed definition, the
+// reference is an error.
 Expr const*
 Parser::on_id(Token tok)
 {
   Symbol const* sym = tok.symbol();
-  if (Name_binding const* bind = names_.lookup(sym))
-    return new Ref(sym, bind->second);
+  if (Name_binding const* bind = names_.lookup(sym)) {
+    if (is_error_node(bind->second))
+      return make_error_node<Expr>();
+    return make_node<Ref>(sym, bind->second);
+  }
   error(ts_.location(), "no matching variable for '{}'", *sym);
-  throw Name_error();
+  return make_error_node<Expr>();
 }
 
 
@@ -353,12 +419,15 @@ Parser::on_id(Token tok)
 //
 // This would allow me to assign a type to the identifier
 // before parsing and typing its definition.
+//
+// When checking is deferred, the type of the variable is
+// assigned by the checker.
 Expr const*
 Parser::on_def(Token tok, Expr const* e)
 {
-  Type const* t = e->type();
+  Type const* t = check_ ? e->type() : nullptr;
   Var const* v = on_var(tok, t);
-  return new Def(v, e);
+  return make_node<Def>(v, e);
 }
 
 
@@ -366,7 +435,7 @@ Parser::on_def(Token tok, Expr const* e)
 Expr const*
 Parser::on_decl(Var const* v)
 {
-  return new Decl(v);
+  return make_node<Decl>(v);
 }
 
 
@@ -376,8 +445,10 @@ Parser::on_decl(Var const* v)
 Expr const*
 Parser::on_abs(Var const* v, Expr const* e)
 {
+  if (!check_)
+    return make_node<Abs>(nullptr, v, e);
   Type const* t = get_arrow_type(v->type(), e->type());
-  return new Abs(t, v, e);
+  return make_node<Abs>(t, v, e);
 }
 
 
@@ -386,34 +457,50 @@ Parser::on_abs(Var const* v, Expr const* e)
 //        G |- e1 e2 : T2
 //
 // TODO: Improve diagnostics.
+//
+// When checking is deferred, the application records the
+// location at which a type error would have been diagnosed.
 Expr const*
 Parser::on_app(Expr const* e1, Expr const* e2)
 {
+  if (!check_) {
+    App* e = make_node<App>(nullptr, e1, e2);
+    e->loc_ = ts_.location();
+    return e;
+  }
+
   // e1 shall have arrow type.
   Arrow_type const* a = as<Arrow_type>(e1->type());
   if (!a) {
     error(ts_.location(), "expression does not have arrow type");
-    throw Type_error();
+    return make_error_node<Expr>();
   }
   Type const* t1 = a->in();
   Type const* t2 = a->out();
 
   // The type of e2 shall match t1.
-  if (e2->type() != t1) {
+  if (!is_same(e2->type(), t1)) {
     error(ts_.location(), "type mismatch in application");
-    throw Type_error();
+    return make_error_node<Expr>();
   }
 
   // The type of the expression shall be t2.
-  return new App(t2, e1, e2);
+  return make_node<App>(t2, e1, e2);
 }
 
 
-// Types are ignored.
+// Types are ignored. Ill-formed statements are dropped from
+// the sequence, so that deferred type checking still diagnoses
+// the well-formed ones. The sequence is an error only if both
+// statements are ill-formed.
 Expr const*
 Parser::on_seq(Expr const* e1, Expr const* e2)
 {
-  return new Seq(e1, e2);
+  if (is_error_node(e1))
+    return e2;
+  if (is_error_node(e2))
+    return e1;
+  return make_node<Seq>(e1, e2);
 }
 
 
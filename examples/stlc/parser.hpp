@@ -8,6 +8,7 @@
 #include "ast.hpp"
 
 #include <lingo/environment.hpp>
+#include <lingo/recovery.hpp>
 
 namespace calc
 {
@@ -21,24 +22,6 @@ struct Translation_error : std::runtime_error
 };
 
 
-// Denotes a parse error.
-struct Parse_error : Translation_error
-{
-  Parse_error()
-    : Translation_error("parse error")
-  { }
-};
-
-
-// Indicates a name (lookup) error.
-struct Name_error : Translation_error
-{
-  Name_error()
-    : Translation_error("name error")
-  { }
-};
-
-
 // Denotes a type error.
 struct Type_error : Translation_error
 {
@@ -50,19 +33,29 @@ struct Type_error : Translation_error
 
 // The naming environment associates names with their
 // definitions. Note that a symbol can be bound to either
-// a variable (Var) or definition (Def).
-using Name_map = Environment<Symbol const*, Var const*>;
-using Name_binding = Name_map::Binding;
-using Name_stack = Stack<Name_map>;
+// a variable (Var) or definition (Def). Each symbol's slot
+// refers to its innermost binding, so names are resolved in
+// constant time.
+using Name_stack = Slot_stack<Var const*>;
+using Name_binding = Name_stack::Binding;
 
 
 // The parser is responsible for transforming a stream of tokens
 // into nodes. The parser owns a reference to the buffer for its
 // tokens. This supports the resolution of source code locations.
+//
+// By default, terms are type checked as they are parsed. When
+// checking is deferred, the parser only resolves names, and the
+// types of terms are assigned later by the checker (see
+// checker.hpp).
+//
+// The parser does not throw exceptions. Errors are diagnosed
+// and ill-formed terms are parsed as error nodes. An ill-formed
+// statement is skipped so that parsing resumes with the next.
 struct Parser
 {
-  Parser(Token_stream& ts)
-    : ts_(ts)
+  Parser(Token_stream& ts, bool check = true)
+    : ts_(ts), check_(check)
   { }
 
   Expr const* operator()();
@@ -81,6 +74,7 @@ struct Parser
   Expr const* primary();
   Expr const* app();
   Expr const* postfix();
+  Expr const* stmt();
   Expr const* seq();
   Expr const* expr();
 
@@ -105,6 +99,8 @@ struct Parser
 
   Token_stream& ts_;
   Name_stack    names_;
+  Recovery      recovery_;
+  bool          check_;
 
   // Name binding support.
   struct Environment {
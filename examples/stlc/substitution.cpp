@@ -2,8 +2,11 @@
 // All rights reserved
 
 #include "substitution.hpp"
+#include "free.hpp"
 #include "ast.hpp"
 
+#include <algorithm>
+
 namespace calc
 {
 
@@ -14,9 +17,30 @@ Substitution::operator()(Expr const* e) const
 }
 
 
+// Returns true if some variable in the domain of the
+// substitution occurs free in `e`.
+bool
+Substitution::affects(Expr const* e) const
+{
+  Var_set const& fv = free_vars(e);
+  if (fv.empty())
+    return false;
+  for (auto const& x : *this) {
+    if (std::binary_search(fv.begin(), fv.end(), x.first))
+      return true;
+  }
+  return false;
+}
+
+
+// Apply the substitution to `e`. If `e` is unaffected by
+// the substitution, then it is returned.
 Expr const*
 Substitution::subst(Expr const* e) const
 {
+  if (!affects(e))
+    return e;
+
   struct Fn
   {
     Substitution const& subst;
@@ -80,30 +104,45 @@ Substitution::subst(Decl const* e) const
 }
 
 
+// Substitute through an abstraction.
+//
+//    [x->s]\y:T.e = \y:T.[x->s]e
 Expr const*
 Substitution::subst(Abs const* e) const
 {
   Var const* v = cast<Var>(subst(e->var()));
   Expr const* d = subst(e->expr());
-  return new Abs(e->type(), v, d);
+  if (v == e->var() && d == e->expr())
+    return e;
+  return make_node<Abs>(e->type(), v, d);
 }
 
 
+// Substitute through an application.
+//
+//    [x->s](e1 e2) = [x->s]e1 [x->s]e2
 Expr const*
 Substitution::subst(App const* e) const
 {
   Expr const* e1 = subst(e->fn());
   Expr const* e2 = subst(e->arg());
-  return new App(e->type(), e1, e2);
+  if (e1 == e->fn() && e2 == e->arg())
+    return e;
+  return make_node<App>(e->type(), e1, e2);
 }
 
 
+// Substitute through a sequence.
+//
+//    [x->s](e1 ; e2) = [x->s]e1 ; [x->s]e2
 Expr const*
 Substitution::subst(Seq const* e) const
 {
   Expr const* e1 = subst(e->left());
   Expr const* e2 = subst(e->right());
-  return new App(e->type(), e1, e2);
+  if (e1 == e->left() && e2 == e->right())
+    return e;
+  return make_node<Seq>(e1, e2);
 }
 
 
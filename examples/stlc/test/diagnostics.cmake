@@ -0,0 +1,32 @@
+# Copyright (c) 2015 Andrew Sutton
+# All rights reserved
+
+# Checks that stlc reports the same errors for INPUT whether it
+# type checks while parsing or after parsing (--parallel). Errors
+# are compared without regard to order, since deferred checking
+# reports type errors after syntax errors.
+#
+#   cmake -DSTLC=<stlc> -DINPUT=<file> -P diagnostics.cmake
+
+function(stlc_errors var)
+  execute_process(COMMAND ${STLC} ${ARGN} ${INPUT}
+                  OUTPUT_VARIABLE out
+                  ERROR_VARIABLE out)
+  # Semicolons separate list elements.
+  string(REPLACE ";" "<semi>" out "${out}")
+  string(REGEX MATCHALL "error:[^\n]*" errs "${out}")
+  list(SORT errs)
+  set(${var} "${errs}" PARENT_SCOPE)
+endfunction()
+
+stlc_errors(inline)
+stlc_errors(deferred --parallel=2)
+
+if(NOT inline)
+  message(FATAL_ERROR "no errors reported for ${INPUT}")
+endif()
+if(NOT inline STREQUAL deferred)
+  string(REPLACE ";" "\n  " inline "${inline}")
+  string(REPLACE ";" "\n  " deferred "${deferred}")
+  message(FATAL_ERROR "errors differ:\ninline:\n  ${inline}\nparallel:\n  ${deferred}")
+endif()
@@ -0,0 +1,138 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "vm.hpp"
+#include "substitution.hpp"
+
+#include <lingo/error.hpp>
+#include <lingo/trace.hpp>
+
+#include <stdexcept>
+
+namespace calc
+{
+
+// Initialize the machine for the given program. Each constant
+// of arrow type is given a closure with no function.
+Machine::Machine(Program const& p, std::ostream& os)
+  : prog_(p), out_(os), globals_(p.globals.size()), constants_(p.constants.size())
+{
+  for (std::size_t i = 0; i < p.constants.size(); ++i) {
+    Var const* v = p.constants[i];
+    if (is<Arrow_type>(v->type())) {
+      heap_.push_back(Closure{nullptr, v, {}});
+      constants_[i].clo = &heap_.back();
+    } else {
+      constants_[i].con = v;
+    }
+  }
+}
+
+
+// Run the program and return the term denoted by its result,
+// or nullptr if the program produces no value.
+Expr const*
+Machine::operator()()
+{
+  lingo_trace_scope("run");
+  Value v = run();
+  if (prog_.result)
+    return readback(v, prog_.result);
+  return nullptr;
+}
+
+
+// Execute the program. If the program produces no value, the
+// result is unspecified.
+Value
+Machine::run()
+{
+  frames_.push_back({&prog_.functions[0], nullptr, Value(), 0});
+  while (true) {
+    Frame& f = frames_.back();
+    Instr i = f.fn->code[f.pc++];
+    switch (i.op) {
+      case local_op:
+        stack_.push_back(f.arg);
+        break;
+
+      case capture_op:
+        stack_.push_back(f.clo->env[i.arg]);
+        break;
+
+      case global_op:
+        stack_.push_back(globals_[i.arg]);
+        break;
+
+      case constant_op:
+        stack_.push_back(constants_[i.arg]);
+        break;
+
+      case closure_op: {
+        Function const* fn = &prog_.functions[i.arg];
+        auto first = stack_.end() - fn->captures.size();
+        heap_.push_back(Closure{fn, nullptr, {first, stack_.end()}});
+        stack_.erase(first, stack_.end());
+        Value v;
+        v.clo = &heap_.back();
+        stack_.push_back(v);
+        break;
+      }
+
+      case apply_op: {
+        Value arg = stack_.back();
+        stack_.pop_back();
+        Closure const* clo = stack_.back().clo;
+        stack_.pop_back();
+        if (!clo->fn) {
+          String msg = format("application of non-abstraction '{}'", *clo->con->name());
+          throw std::runtime_error(msg);
+        }
+        frames_.push_back({clo->fn, clo, arg, 0});
+        break;
+      }
+
+      case define_op:
+        globals_[i.arg] = stack_.back();
+        stack_.pop_back();
+        break;
+
+      case print_op:
+        out_ << *readback(stack_.back(), prog_.types[i.arg]) << '\n';
+        stack_.pop_back();
+        break;
+
+      case return_op:
+        frames_.pop_back();
+        if (frames_.empty())
+          return stack_.empty() ? Value() : stack_.back();
+        break;
+    }
+  }
+}
+
+
+// Returns the term denoted by the value `v` of type `t`. A
+// closure denotes its abstraction with the values of captured
+// variables substituted for them.
+Expr const*
+Machine::readback(Value v, Type const* t)
+{
+  if (is<Base_type>(t))
+    return make_node<Ref>(v.con->name(), v.con);
+
+  Closure const* clo = v.clo;
+  if (!clo->fn)
+    return make_node<Ref>(clo->con->name(), clo->con);
+
+  Function const* fn = clo->fn;
+  Substitution subst;
+  for (std::size_t i = 0; i < fn->captures.size(); ++i) {
+    Var const* x = fn->captures[i];
+    subst.emplace(x, readback(clo->env[i], x->type()));
+  }
+  return subst(fn->abs);
+}
+
+
+} // namespace calc
@@ -0,0 +1,82 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef CALC_VM_HPP
+#define CALC_VM_HPP
+
+// The virtual machine executes compiled programs (see
+// compiler.hpp).
+
+#include "compiler.hpp"
+
+#include <deque>
+#include <iostream>
+#include <vector>
+
+namespace calc
+{
+
+using namespace lingo;
+
+
+struct Closure;
+
+
+// A machine value. Values are not tagged: the static type of the
+// slot holding a value determines its representation. Values of
+// arrow type are closures and values of base type are constants.
+union Value
+{
+  Closure const* clo;
+  Var const*     con;
+};
+
+
+// A closure pairs a function with the values of its captured
+// variables. A constant of arrow type is represented by a
+// closure with no function; applying it is an error.
+struct Closure
+{
+  Function const*    fn;
+  Var const*         con;
+  std::vector<Value> env;
+};
+
+
+// The machine executes the program using an explicit stack of
+// activation frames, so the depth of evaluation is not limited
+// by the native call stack.
+//
+// As with the evaluator, the values of the left operands of
+// sequences are printed to the given output stream.
+struct Machine
+{
+  Machine(Program const&, std::ostream& = std::cout);
+
+  Expr const* operator()();
+
+  Value       run();
+  Expr const* readback(Value, Type const*);
+
+  // An activation record.
+  struct Frame
+  {
+    Function const* fn;
+    Closure const*  clo;
+    Value           arg;
+    int             pc;
+  };
+
+  Program const&      prog_;
+  std::ostream&       out_;
+  std::vector<Value>  globals_;
+  std::vector<Value>  constants_;
+  std::vector<Value>  stack_;
+  std::vector<Frame>  frames_;
+  std::deque<Closure> heap_;
+};
+
+
+} // namespace calc
+
+#endif
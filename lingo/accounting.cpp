@@ -0,0 +1,122 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/accounting.hpp"
+
+#include <iomanip>
+#include <iostream>
+
+namespace lingo
+{
+
+namespace
+{
+
+// The counts of a subsystem.
+struct Memory_counts
+{
+  std::atomic<std::size_t> current;
+  std::atomic<std::size_t> peak;
+  std::atomic<std::size_t> allocations;
+};
+
+
+Memory_counts counts_[memory_subsystem_count];
+
+
+} // namespace
+
+
+char const*
+get_memory_subsystem_name(Memory_subsystem s)
+{
+  switch (s) {
+    case symbol_memory: return "symbols";
+    case token_memory: return "tokens";
+    case line_memory: return "lines";
+    case gc_memory: return "gc";
+    case diagnostic_memory: return "diagnostics";
+    case arena_memory: return "arenas";
+    default: break;
+  }
+  return "<unknown>";
+}
+
+
+// Record the allocation of `n` bytes, updating the high-water
+// mark if needed.
+void
+record_allocation(Memory_subsystem s, std::size_t n)
+{
+  Memory_counts& c = counts_[s];
+  std::size_t cur = c.current.fetch_add(n, std::memory_order_relaxed) + n;
+  std::size_t peak = c.peak.load(std::memory_order_relaxed);
+  while (cur > peak && !c.peak.compare_exchange_weak(peak, cur, std::memory_order_relaxed))
+    ;
+  c.allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+
+// Record the deallocation of `n` bytes.
+void
+record_deallocation(Memory_subsystem s, std::size_t n)
+{
+  counts_[s].current.fetch_sub(n, std::memory_order_relaxed);
+}
+
+
+Memory_usage
+get_memory_usage(Memory_subsystem s)
+{
+  Memory_counts const& c = counts_[s];
+  return {
+    c.current.load(std::memory_order_relaxed),
+    c.peak.load(std::memory_order_relaxed),
+    c.allocations.load(std::memory_order_relaxed)
+  };
+}
+
+
+// Reset the high-water mark of each subsystem to its current
+// usage. This allows the peak usage of a single phase to be
+// measured.
+void
+reset_memory_peaks()
+{
+  for (Memory_counts& c : counts_)
+    c.peak.store(c.current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+
+// Write a table of the memory usage of each subsystem.
+void
+report_memory_usage(std::ostream& os)
+{
+  os << std::left << std::setw(16) << "subsystem"
+     << std::right << std::setw(16) << "current (B)"
+     << std::setw(16) << "peak (B)"
+     << std::setw(16) << "allocations" << '\n';
+  Memory_usage total {0, 0, 0};
+  for (int i = 0; i < memory_subsystem_count; ++i) {
+    Memory_usage u = get_memory_usage(Memory_subsystem(i));
+    os << std::left << std::setw(16) << get_memory_subsystem_name(Memory_subsystem(i))
+       << std::right << std::setw(16) << u.current
+       << std::setw(16) << u.peak
+       << std::setw(16) << u.allocations << '\n';
+    total.current += u.current;
+    total.peak += u.peak;
+    total.allocations += u.allocations;
+  }
+
+  // Peaks of different subsystems need not coincide, so the
+  // total peak is only an upper bound.
+  os << std::left << std::setw(16) << "total"
+     << std::right << std::setw(16) << total.current
+     << std::setw(16) << total.peak
+     << std::setw(16) << total.allocations << '\n';
+}
+
+
+} // namespace lingo
@@ -0,0 +1,144 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_ACCOUNTING_HPP
+#define LINGO_ACCOUNTING_HPP
+
+// The accounting module records the memory held by each of
+// lingo's subsystems: the symbol table, token buffers, line
+// maps, the garbage collected heap, diagnostics, and arenas.
+// For each subsystem, it counts the bytes currently allocated,
+// the largest number of bytes that were ever allocated at once
+// (the high-water mark), and the number of allocations.
+//
+// Memory is recorded by allocating through an accounting
+// allocator, or by calling record_allocation() and
+// record_deallocation() directly. Counts are updated with
+// relaxed atomic operations, so they are safe to update from
+// multiple threads, but a report taken while other threads
+// allocate is only approximate.
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Memory usage
+
+// The subsystems whose memory is accounted.
+enum Memory_subsystem
+{
+  symbol_memory,
+  token_memory,
+  line_memory,
+  gc_memory,
+  diagnostic_memory,
+  arena_memory,
+  memory_subsystem_count
+};
+
+
+char const* get_memory_subsystem_name(Memory_subsystem);
+
+
+// The memory usage of a subsystem.
+struct Memory_usage
+{
+  std::size_t current;     // Bytes currently allocated
+  std::size_t peak;        // The high-water mark in bytes
+  std::size_t allocations; // Total number of allocations
+};
+
+
+void record_allocation(Memory_subsystem, std::size_t);
+void record_deallocation(Memory_subsystem, std::size_t);
+
+Memory_usage get_memory_usage(Memory_subsystem);
+void         reset_memory_peaks();
+void         report_memory_usage(std::ostream&);
+
+
+// -------------------------------------------------------------------------- //
+//                            Accounting allocator
+
+// An allocator that records the memory it allocates against
+// the subsystem S. Storage is obtained from std::allocator.
+template<typename T, Memory_subsystem S>
+struct Accounting_allocator
+{
+  using value_type = T;
+
+  template<typename U>
+  struct rebind
+  {
+    using other = Accounting_allocator<U, S>;
+  };
+
+  Accounting_allocator() = default;
+
+  template<typename U>
+  Accounting_allocator(Accounting_allocator<U, S> const&)
+  { }
+
+  T* allocate(std::size_t n)
+  {
+    record_allocation(S, n * sizeof(T));
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(T* p, std::size_t n)
+  {
+    record_deallocation(S, n * sizeof(T));
+    std::allocator<T>().deallocate(p, n);
+  }
+};
+
+
+template<typename T, typename U, Memory_subsystem S>
+inline bool
+operator==(Accounting_allocator<T, S> const&, Accounting_allocator<U, S> const&)
+{
+  return true;
+}
+
+
+template<typename T, typename U, Memory_subsystem S>
+inline bool
+operator!=(Accounting_allocator<T, S> const&, Accounting_allocator<U, S> const&)
+{
+  return false;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Accounted objects
+
+// Deriving from this class records the memory of dynamically
+// allocated objects against the subsystem S. Because the class
+// uses sized deallocation, classes derived from this must have
+// a virtual destructor when objects are deleted through a
+// pointer to a base class.
+template<Memory_subsystem S>
+struct Accounted
+{
+  static void* operator new(std::size_t n)
+  {
+    record_allocation(S, n);
+    return ::operator new(n);
+  }
+
+  static void operator delete(void* p, std::size_t n)
+  {
+    record_deallocation(S, n);
+    ::operator delete(p);
+  }
+};
+
+
+} // namespace lingo
+
+#endif
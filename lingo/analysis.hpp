@@ -0,0 +1,338 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_ANALYSIS_HPP
+#define LINGO_ANALYSIS_HPP
+
+// The analysis module caches the results of analyses of nodes.
+// An analysis is a function that computes some property of a
+// node (e.g., the variables that occur free in a term). When
+// nodes are immutable, the property never changes, so it can be
+// computed once and saved:
+//
+//    Var_set compute(Expr const*);
+//    Analysis<Expr, Var_set> free_vars(compute);
+//
+//    Var_set const& s = free_vars(e);
+//
+// The analysis function may apply the analysis to the children
+// of a node. Each child's result is computed and saved first,
+// so the analysis proceeds bottom-up, and shared subterms are
+// analyzed only once.
+//
+// The results of numbered nodes (see Numbered_node in
+// lingo/node.hpp) are saved in a side table indexed by node id.
+// Those nodes shall have been created by the same factory.
+// Results of other nodes are indexed by the address of the node.
+// A node must not be deallocated while its result is saved,
+// since its address or id could be reused by a different node.
+// Use erase() or clear() to discard results.
+
+#include <lingo/assert.hpp>
+#include <lingo/cache.hpp>
+#include <lingo/node.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Side tables
+
+// A side table maps node ids to values of type T. Values are
+// stored in pages of contiguous memory, indexed by id, so that
+// lookup does not hash and the values of nodes with nearby ids
+// are adjacent. Pages are never moved, so references to values
+// remain valid as the table grows.
+//
+// T shall be default constructible. Note that the pages hold a
+// value for every id in their range, even those not in the table.
+template<typename T>
+class Side_table
+{
+public:
+  static constexpr int page_size = 256;
+
+  Side_table()
+    : count_(0)
+  { }
+
+  T const* find(int) const;
+  T*       find(int);
+  T&       put(int, T const&);
+  T&       put(int, T&&);
+  T&       operator[](int);
+
+  void erase(int);
+  void clear();
+
+  // Returns the number of values in the table.
+  std::size_t size() const { return count_; }
+
+private:
+  struct Page
+  {
+    Page()
+      : values(), set()
+    { }
+
+    T    values[page_size];
+    bool set[page_size];
+  };
+
+  Page* page(int) const;
+  Page& grow(int);
+
+  std::vector<std::unique_ptr<Page>> pages_;
+  std::size_t                        count_;
+};
+
+
+// Returns the page holding the value for `n`, or null if
+// there is none.
+template<typename T>
+inline auto
+Side_table<T>::page(int n) const -> Page*
+{
+  lingo_assert(n >= 0);
+  std::size_t p = n / page_size;
+  return p < pages_.size() ? pages_[p].get() : nullptr;
+}
+
+
+// Returns the page holding the value for `n`, allocating it
+// if needed.
+template<typename T>
+auto
+Side_table<T>::grow(int n) -> Page&
+{
+  lingo_assert(n >= 0);
+  std::size_t p = n / page_size;
+  if (p >= pages_.size())
+    pages_.resize(p + 1);
+  if (!pages_[p])
+    pages_[p].reset(new Page());
+  return *pages_[p];
+}
+
+
+// Returns the value for `n`, or null if there is none.
+template<typename T>
+inline T const*
+Side_table<T>::find(int n) const
+{
+  Page* p = page(n);
+  if (p && p->set[n % page_size])
+    return &p->values[n % page_size];
+  return nullptr;
+}
+
+
+template<typename T>
+inline T*
+Side_table<T>::find(int n)
+{
+  Page* p = page(n);
+  if (p && p->set[n % page_size])
+    return &p->values[n % page_size];
+  return nullptr;
+}
+
+
+// Save the value `x` for `n`, replacing any previous value.
+template<typename T>
+inline T&
+Side_table<T>::put(int n, T const& x)
+{
+  T& v = (*this)[n];
+  v = x;
+  return v;
+}
+
+
+template<typename T>
+inline T&
+Side_table<T>::put(int n, T&& x)
+{
+  T& v = (*this)[n];
+  v = std::move(x);
+  return v;
+}
+
+
+// Returns the value for `n`. If there is none, a default
+// value is added.
+template<typename T>
+inline T&
+Side_table<T>::operator[](int n)
+{
+  Page& p = grow(n);
+  if (!p.set[n % page_size]) {
+    p.set[n % page_size] = true;
+    ++count_;
+  }
+  return p.values[n % page_size];
+}
+
+
+// Remove the value for `n`, if any.
+template<typename T>
+inline void
+Side_table<T>::erase(int n)
+{
+  Page* p = page(n);
+  if (p && p->set[n % page_size]) {
+    p->set[n % page_size] = false;
+    p->values[n % page_size] = T();
+    --count_;
+  }
+}
+
+
+// Remove all values, releasing the pages.
+template<typename T>
+inline void
+Side_table<T>::clear()
+{
+  pages_.clear();
+  count_ = 0;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Analysis tables
+
+// The table in which an analysis saves the results for nodes of
+// type N. The results of numbered nodes are saved in a side table.
+// Otherwise, results are saved in a hash table.
+template<typename N, typename T, bool = is_numbered_node<N>()>
+struct Analysis_table
+{
+  T const* find(N const* n) const
+  {
+    auto iter = map.find(n);
+    return iter != map.end() ? &iter->second : nullptr;
+  }
+
+  T const& put(N const* n, T&& x)
+  {
+    return map.emplace(n, std::move(x)).first->second;
+  }
+
+  void        erase(N const* n) { map.erase(n); }
+  void        clear()           { map.clear(); }
+  std::size_t size() const      { return map.size(); }
+
+  std::unordered_map<N const*, T> map;
+};
+
+
+template<typename N, typename T>
+struct Analysis_table<N, T, true>
+{
+  T const* find(N const* n) const { return table.find(n->node_id()); }
+
+  T const& put(N const* n, T&& x)
+  {
+    return table.put(n->node_id(), std::move(x));
+  }
+
+  void        erase(N const* n) { table.erase(n->node_id()); }
+  void        clear()           { table.clear(); }
+  std::size_t size() const      { return table.size(); }
+
+  Side_table<T> table;
+};
+
+
+// -------------------------------------------------------------------------- //
+//                            Analysis cache
+
+// An analysis of nodes of type N that produces values of type T.
+template<typename N, typename T>
+class Analysis
+{
+public:
+  using Node_type = N;
+  using Value_type = T;
+  using Function = T (*)(N const*);
+
+  explicit Analysis(Function f)
+    : fn_(f)
+  { }
+
+  T const& operator()(N const*);
+
+  T const* find(N const*) const;
+  void     erase(N const*);
+  void     clear();
+
+  // Returns the number of saved results.
+  std::size_t size() const { return table_.size(); }
+
+  // Returns the lookup statistics of the cache.
+  Cache_stats const& stats() const { return stats_; }
+
+private:
+  Function             fn_;
+  Analysis_table<N, T> table_;
+  Cache_stats          stats_;
+};
+
+
+// Returns the result of the analysis for `n`, computing it if
+// it has not been saved. The returned reference remains valid
+// until the result is erased.
+template<typename N, typename T>
+T const&
+Analysis<N, T>::operator()(N const* n)
+{
+  if (T const* r = table_.find(n)) {
+    ++stats_.hits;
+    return *r;
+  }
+  ++stats_.misses;
+
+  // Computing the result may save the results of other nodes,
+  // which does not invalidate references to saved results.
+  T value = fn_(n);
+  return table_.put(n, std::move(value));
+}
+
+
+// Returns the saved result for `n`, or null if there is none.
+template<typename N, typename T>
+inline T const*
+Analysis<N, T>::find(N const* n) const
+{
+  return table_.find(n);
+}
+
+
+// Discard the saved result for `n`, if any.
+template<typename N, typename T>
+inline void
+Analysis<N, T>::erase(N const* n)
+{
+  table_.erase(n);
+}
+
+
+// Discard all saved results.
+template<typename N, typename T>
+inline void
+Analysis<N, T>::clear()
+{
+  table_.clear();
+  stats_ = Cache_stats();
+}
+
+
+} // namespace lingo
+
+#endif
@@ -0,0 +1,84 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/arena.hpp"
+
+#include <algorithm>
+
+namespace lingo
+{
+
+Arena::Arena(std::size_t n)
+  : block_size_(n), cur_(0), used_(0), total_(0)
+{ }
+
+
+Arena::~Arena()
+{
+  clear();
+}
+
+
+// Move to the next block that can hold `n` bytes aligned to
+// `a`, and allocate from it. Blocks that were released by a
+// rollback are reused when they are large enough. Otherwise, a
+// new block is inserted after the current one.
+void*
+Arena::grow(std::size_t n, std::size_t a)
+{
+  // Any space left in the current block is wasted.
+  std::size_t next = 0;
+  if (cur_ < blocks_.size()) {
+    total_ += blocks_[cur_].size - used_;
+    next = cur_ + 1;
+  }
+
+  if (next == blocks_.size() || blocks_[next].size < n + a) {
+    std::size_t size = std::max(block_size_, n + a);
+    record_allocation(arena_memory, size);
+    blocks_.insert(blocks_.begin() + next, {new char[size], size});
+  }
+  cur_ = next;
+  used_ = 0;
+  return allocate(n, a);
+}
+
+
+// Release everything allocated after the watermark `w`.
+void
+Arena::rollback(Watermark const& w)
+{
+  cur_ = w.block;
+  used_ = w.used;
+  total_ = w.total;
+}
+
+
+// Release all blocks held by the arena.
+void
+Arena::clear()
+{
+  for (Block& b : blocks_) {
+    record_deallocation(arena_memory, b.size);
+    delete[] b.data;
+  }
+  blocks_.clear();
+  cur_ = 0;
+  used_ = 0;
+  total_ = 0;
+}
+
+
+std::size_t
+Arena::capacity() const
+{
+  std::size_t n = 0;
+  for (Block const& b : blocks_)
+    n += b.size;
+  return n;
+}
+
+
+} // namespace lingo
@@ -0,0 +1,124 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_ARENA_HPP
+#define LINGO_ARENA_HPP
+
+// The arena module provides region-based allocation. An arena
+// allocates objects by advancing a pointer within large blocks
+// of memory. Objects are not freed individually. Instead, the
+// arena's watermark can be saved and everything allocated after
+// it released at once:
+//
+//    Arena::Watermark w = arena.watermark();
+//    Expr* e = arena.make<Int>(...);
+//    arena.rollback(w); // Releases e
+//
+// Released blocks are kept and reused by later allocations, so
+// rolling back takes constant time. Memory is returned to the
+// system only when the arena is destroyed or cleared.
+//
+// Note that the destructors of objects made in an arena are
+// never called. Those objects should not own resources.
+
+#include <lingo/accounting.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Arenas
+
+class Arena
+{
+public:
+  // A position in the arena: the current block and the number
+  // of bytes used in it, along with the total number of bytes
+  // allocated before that position.
+  struct Watermark
+  {
+    std::size_t block;
+    std::size_t used;
+    std::size_t total;
+  };
+
+  explicit Arena(std::size_t = 64 * 1024);
+  ~Arena();
+
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  void* allocate(std::size_t, std::size_t = alignof(std::max_align_t));
+
+  template<typename T, typename... Args>
+  T* make(Args&&...);
+
+  // Returns the current watermark.
+  Watermark watermark() const { return {cur_, used_, total_}; }
+
+  void rollback(Watermark const&);
+  void clear();
+
+  // Returns the number of bytes allocated below the current
+  // position, including padding and space skipped at the ends
+  // of blocks.
+  std::size_t size() const { return total_; }
+
+  // Returns the number of bytes held by the arena's blocks.
+  std::size_t capacity() const;
+
+private:
+  struct Block
+  {
+    char*       data;
+    std::size_t size;
+  };
+
+  void* grow(std::size_t, std::size_t);
+
+  std::vector<Block> blocks_;
+  std::size_t        block_size_; // The size of new blocks
+  std::size_t        cur_;        // Index of the current block
+  std::size_t        used_;       // Bytes used in the current block
+  std::size_t        total_;      // Bytes allocated in all blocks
+};
+
+
+// Allocate `n` bytes aligned to `a`, which shall be a power
+// of 2.
+inline void*
+Arena::allocate(std::size_t n, std::size_t a)
+{
+  if (cur_ < blocks_.size()) {
+    Block& b = blocks_[cur_];
+    std::size_t pad = -reinterpret_cast<std::uintptr_t>(b.data + used_) & (a - 1);
+    if (used_ + pad + n <= b.size) {
+      void* p = b.data + used_ + pad;
+      used_ += pad + n;
+      total_ += pad + n;
+      return p;
+    }
+  }
+  return grow(n, a);
+}
+
+
+// Allocate and construct an object of type T.
+template<typename T, typename... Args>
+inline T*
+Arena::make(Args&&... args)
+{
+  void* p = allocate(sizeof(T), alignof(T));
+  return new (p) T(std::forward<Args>(args)...);
+}
+
+
+} // namespace lingo
+
+#endif
@@ -5,18 +5,39 @@
 
 #include "lingo/buffer.hpp"
 #include "lingo/error.hpp"
+#include "lingo/trace.hpp"
 
 #include <iostream>
 
 namespace lingo
 {
 
-// Initialize the buffer with the given text. Perform a cursory
-// analysis of the input in order to construct the line map
-// for the input source.
+// Initialize the buffer with the given text.
 Buffer::Buffer(String const& str)
   : text_(str), lines_()
 {
+  index_lines();
+}
+
+
+// Replace the `n` characters starting at offset `pos` with
+// the text `str`. Locations past the replaced text are not
+// adjusted.
+void
+Buffer::replace(int pos, int n, String const& str)
+{
+  text_.replace(pos, n, str);
+  lines_.clear();
+  index_lines();
+}
+
+
+// Perform a cursory analysis of the input in order to
+// construct the line map for the input source.
+void
+Buffer::index_lines()
+{
+  lingo_trace_scope("line map");
   char const *first = &text_.front();
   char const *last = first + text_.size();
   char const *iter = first;
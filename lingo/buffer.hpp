@@ -44,7 +44,12 @@ public:
   String_view   rep() const { return {begin(), end()}; }
   String const& str() const { return text_; }
 
+  // Modifiers
+  void replace(int, int, String const&);
+
 protected:
+  void index_lines();
+
   String   text_;
   Line_map lines_;
 };
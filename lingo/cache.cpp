@@ -0,0 +1,28 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/cache.hpp"
+
+#include <iostream>
+
+namespace lingo
+{
+
+
+// Print a one-line summary of the cache statistics.
+std::ostream&
+operator<<(std::ostream& os, Cache_stats const& s)
+{
+  os << s.lookups() << " lookups, "
+     << s.hits << " hits, "
+     << s.misses << " misses, "
+     << s.evictions << " evictions";
+  if (s.lookups())
+    os << " (" << int(s.hit_rate() * 100) << "% hit rate)";
+  return os;
+}
+
+
+} // namespace lingo
@@ -0,0 +1,177 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_CACHE_HPP
+#define LINGO_CACHE_HPP
+
+// The cache module provides bounded associative containers
+// for memoizing the results of expensive computations.
+
+#include <lingo/assert.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <iosfwd>
+#include <list>
+#include <unordered_map>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Cache statistics
+
+// Counts the outcome of each cache lookup. These are
+// maintained by the cache and can be printed to show how
+// effective memoization was for a particular workload.
+struct Cache_stats
+{
+  Cache_stats()
+    : hits(0), misses(0), evictions(0)
+  { }
+
+  // Returns the number of lookups performed.
+  std::size_t lookups() const { return hits + misses; }
+
+  // Returns the ratio of hits to lookups.
+  double hit_rate() const
+  {
+    return lookups() ? double(hits) / lookups() : 0.0;
+  }
+
+  std::size_t hits;      // Lookups that found an entry
+  std::size_t misses;    // Lookups that did not
+  std::size_t evictions; // Entries discarded to make room
+};
+
+
+std::ostream& operator<<(std::ostream&, Cache_stats const&);
+
+
+// -------------------------------------------------------------------------- //
+//                            LRU cache
+
+// A least-recently-used cache maps keys to values, retaining
+// at most `capacity()` entries. When the cache is full, inserting
+// a new entry discards the entry that was least recently looked
+// up or inserted.
+//
+// Entries are kept in a list ordered by recency of use, and a
+// hash table maps each key to its position in that list. Both
+// lookup and insertion are constant time (expected).
+template<typename K, typename V, typename H = std::hash<K>, typename E = std::equal_to<K>>
+class Lru_cache
+{
+  using Entry = std::pair<K, V>;
+  using List  = std::list<Entry>;
+  using Map   = std::unordered_map<K, typename List::iterator, H, E>;
+
+public:
+  using key_type    = K;
+  using mapped_type = V;
+
+  explicit Lru_cache(std::size_t);
+
+  V const* get(K const&);
+  void     put(K const&, V const&);
+  void     clear();
+
+  // Returns the number of entries in the cache.
+  std::size_t size() const { return list_.size(); }
+
+  // Returns the maximum number of entries in the cache.
+  std::size_t capacity() const { return cap_; }
+
+  // Returns the lookup statistics for the cache.
+  Cache_stats const& stats() const { return stats_; }
+
+private:
+  std::size_t cap_;
+  List        list_;  // Most recently used first
+  Map         map_;
+  Cache_stats stats_;
+};
+
+
+// Initialize an empty cache that holds at most n entries.
+// The capacity shall be positive.
+template<typename K, typename V, typename H, typename E>
+inline
+Lru_cache<K, V, H, E>::Lru_cache(std::size_t n)
+  : cap_(n)
+{
+  lingo_assert(n > 0);
+}
+
+
+// Returns a pointer to the value associated with `k` or
+// nullptr if there is no such entry. A successful lookup
+// makes the entry the most recently used.
+//
+// Note that the returned pointer is invalidated by the
+// next insertion into the cache.
+template<typename K, typename V, typename H, typename E>
+V const*
+Lru_cache<K, V, H, E>::get(K const& k)
+{
+  auto iter = map_.find(k);
+  if (iter == map_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+  ++stats_.hits;
+  list_.splice(list_.begin(), list_, iter->second);
+  return &iter->second->second;
+}
+
+
+// Associate the value `v` with the key `k`, replacing any
+// previous association. If the cache is full, the least
+// recently used entry is evicted.
+template<typename K, typename V, typename H, typename E>
+void
+Lru_cache<K, V, H, E>::put(K const& k, V const& v)
+{
+  auto iter = map_.find(k);
+  if (iter != map_.end()) {
+    iter->second->second = v;
+    list_.splice(list_.begin(), list_, iter->second);
+    return;
+  }
+
+  if (list_.size() == cap_) {
+    map_.erase(list_.back().first);
+    list_.pop_back();
+    ++stats_.evictions;
+  }
+  list_.emplace_front(k, v);
+  map_.emplace(k, list_.begin());
+}
+
+
+// Remove all entries from the cache. Statistics are
+// retained.
+template<typename K, typename V, typename H, typename E>
+inline void
+Lru_cache<K, V, H, E>::clear()
+{
+  map_.clear();
+  list_.clear();
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Hashing
+
+// Combine the hash value `h` into the `seed`. This is the
+// mixing function used by Boost.
+inline std::size_t
+hash_combine(std::size_t seed, std::size_t h)
+{
+  return seed ^ (h + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+
+} // namespace lingo
+
+#endif
@@ -35,6 +35,11 @@ public:
     : buf_(b), base_(b.begin()), first_(base_), last_(b.end())
   { }
 
+  // Initialize the stream to start at the offset `n`.
+  Character_stream(Buffer& b, int n)
+    : buf_(b), base_(b.begin()), first_(base_ + n), last_(b.end())
+  { }
+
   // Stream control
   bool eof() const     { return first_ == last_; }
   char peek() const;
@@ -0,0 +1,138 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_CHECKPOINT_HPP
+#define LINGO_CHECKPOINT_HPP
+
+// The checkpoint module supports speculative parsing, where a
+// parser tries one interpretation of the input and backtracks
+// if it fails. A checkpoint saves the position of the stream,
+// a mark in the active diagnostic context, and the watermark of
+// the arena in which nodes are allocated:
+//
+//    Checkpoint<Token_stream> cp(ts_, arena_);
+//    if (Required<Expr> e = cast_expr()) {
+//      cp.commit();
+//      return *e;
+//    }
+//    cp.rollback();
+//    return unary_expr();
+//
+// Rolling back restores all three. Nothing is copied when the
+// checkpoint is made, so an abandoned parse costs only the
+// work that it did. Diagnostics emitted while speculating are
+// printed only when the outermost checkpoint is committed (see
+// Diagnostic_context in lingo/error.hpp), and nodes allocated
+// in the arena are released by a rollback.
+//
+// A checkpoint that is neither committed nor rolled back is
+// rolled back when it is destroyed. Nested checkpoints shall be
+// committed or rolled back in the reverse order they were made.
+
+#include <lingo/arena.hpp>
+#include <lingo/error.hpp>
+
+#include <utility>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Checkpoints
+
+// A checkpoint in the stream S, which can be any that provides
+// position() and reposition(), including token streams and
+// parse states.
+template<typename S>
+class Checkpoint
+{
+public:
+  using Position = decltype(std::declval<S const&>().position());
+
+  explicit Checkpoint(S&);
+  Checkpoint(S&, Arena&);
+  ~Checkpoint();
+
+  Checkpoint(Checkpoint const&) = delete;
+  Checkpoint& operator=(Checkpoint const&) = delete;
+
+  void rollback();
+  void commit();
+
+  // Returns true if the checkpoint has not been committed or
+  // rolled back.
+  bool active() const { return active_; }
+
+private:
+  S&               s_;
+  Arena*           arena_;
+  Position         pos_;
+  Diagnostic_mark  diags_;
+  Arena::Watermark mem_;
+  bool             active_;
+};
+
+
+template<typename S>
+inline
+Checkpoint<S>::Checkpoint(S& s)
+  : s_(s)
+  , arena_(nullptr)
+  , pos_(s.position())
+  , diags_(mark_diagnostics())
+  , mem_()
+  , active_(true)
+{ }
+
+
+template<typename S>
+inline
+Checkpoint<S>::Checkpoint(S& s, Arena& a)
+  : s_(s)
+  , arena_(&a)
+  , pos_(s.position())
+  , diags_(mark_diagnostics())
+  , mem_(a.watermark())
+  , active_(true)
+{ }
+
+
+template<typename S>
+inline
+Checkpoint<S>::~Checkpoint()
+{
+  if (active_)
+    rollback();
+}
+
+
+// Restore the stream position, discard the diagnostics emitted
+// since the checkpoint, and release the memory allocated in the
+// arena since the checkpoint.
+template<typename S>
+inline void
+Checkpoint<S>::rollback()
+{
+  lingo_assert(active_);
+  s_.reposition(pos_);
+  rollback_diagnostics(diags_);
+  if (arena_)
+    arena_->rollback(mem_);
+  active_ = false;
+}
+
+
+// Accept the results of parsing since the checkpoint.
+template<typename S>
+inline void
+Checkpoint<S>::commit()
+{
+  lingo_assert(active_);
+  commit_diagnostics(diags_);
+  active_ = false;
+}
+
+
+} // namespace lingo
+
+#endif
@@ -0,0 +1,159 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_CHILDREN_HPP
+#define LINGO_CHILDREN_HPP
+
+// The children module provides storage for the children of k-ary
+// nodes that is allocated together with the node. A k-ary node
+// usually keeps its children in a std::vector, which allocates a
+// separate array and reaches it through a pointer. A child array
+// is instead a count followed immediately by the children, which
+// occupy memory just past the end of the node:
+//
+//    struct Call : Expr
+//    {
+//      Call(Location loc, Expr const* f, Expr_list const& args)
+//        : Expr(loc), fn(f), args(args)
+//      { }
+//
+//      Child_array<Expr const*>::iterator begin() const { return args.begin(); }
+//      Child_array<Expr const*>::iterator end() const   { return args.end(); }
+//
+//      Expr const*              fn;
+//      Child_array<Expr const*> args; // Must be last
+//    };
+//
+//    Call* c = make_kary<Call>(arena, args, loc, f);
+//
+// The child array shall be the last member of the node, and the
+// node shall be made by make_kary(), which allocates room for the
+// children in an arena (see lingo/arena.hpp). make_kary() checks
+// that the children begin exactly at the end of the node, which
+// fails when members follow the array. Since the check is made
+// after the node is constructed, those members will have been
+// overwritten by then. Nodes shall not be aligned more strictly
+// than std::size_t, so that no padding follows the array. Nodes
+// so made are released with the arena. A child array, like its
+// node, is immutable and cannot be copied.
+//
+// Note that the children are not destroyed, so they shall be
+// trivially destructible, like pointers to nodes.
+
+#include <lingo/arena.hpp>
+#include <lingo/assert.hpp>
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Child arrays
+
+// A length-prefixed array of children of type T, stored in the
+// memory that follows the array object.
+template<typename T>
+class Child_array
+{
+  static_assert(std::is_trivially_destructible<T>::value,
+                "children must be trivially destructible");
+  static_assert(alignof(T) <= alignof(std::size_t),
+                "children must not be over-aligned");
+
+public:
+  using value_type = T;
+  using iterator   = T const*;
+
+  template<typename R>
+  explicit Child_array(R const&);
+
+  Child_array(Child_array const&) = delete;
+  Child_array& operator=(Child_array const&) = delete;
+
+  // Returns the number of children.
+  std::size_t size() const { return size_; }
+  bool        empty() const { return size_ == 0; }
+
+  // Returns the ith child.
+  T const& operator[](std::size_t i) const { return begin()[i]; }
+
+  // Returns the range of children.
+  iterator begin() const { return reinterpret_cast<T const*>(this + 1); }
+  iterator end() const   { return begin() + size_; }
+
+private:
+  T* data() { return reinterpret_cast<T*>(this + 1); }
+
+  std::size_t size_;
+};
+
+
+// Copy the children in the range `r` into the storage following
+// the array. That storage is allocated by make_kary().
+template<typename T>
+template<typename R>
+Child_array<T>::Child_array(R const& r)
+  : size_(0)
+{
+  for (auto const& x : r)
+    new (data() + size_++) T(x);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Node creation
+
+// The type of the children of the k-ary node N.
+template<typename N>
+using Child_type = typename std::decay<decltype(*std::declval<N const&>().begin())>::type;
+
+
+// Returns the number of bytes needed for a node of type N with
+// `n` children stored after it.
+template<typename N>
+constexpr std::size_t
+kary_size(std::size_t n)
+{
+  return sizeof(N) + n * sizeof(Child_type<N>);
+}
+
+
+// Allocate a k-ary node of type N in the arena `a`, with room
+// for the children in the range `r`. The node is constructed with
+// the arguments `args` followed by `r`, which initializes its
+// child array.
+template<typename N, typename R, typename... Args>
+N*
+make_kary(Arena& a, R const& r, Args&&... args)
+{
+  static_assert(alignof(N) <= alignof(std::size_t),
+                "k-ary nodes must not be over-aligned");
+  std::size_t n = std::distance(std::begin(r), std::end(r));
+  void* p = a.allocate(kary_size<N>(n), alignof(N));
+  N* node = new (p) N(std::forward<Args>(args)..., r);
+
+  // The children begin before the end of the node only if
+  // members follow the child array.
+  lingo_assert(std::distance(node->begin(), node->end()) == (std::ptrdiff_t)n);
+  lingo_assert((char const*)&*node->begin() == (char const*)p + sizeof(N));
+  return node;
+}
+
+
+template<typename N, typename... Args>
+inline N*
+make_kary(Arena& a, std::initializer_list<Child_type<N>> r, Args&&... args)
+{
+  return make_kary<N, std::initializer_list<Child_type<N>>>(a, r, std::forward<Args>(args)...);
+}
+
+
+} // namespace lingo
+
+#endif
@@ -0,0 +1,143 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/combinator.hpp"
+
+#include <iterator>
+#include <mutex>
+
+namespace lingo
+{
+
+namespace
+{
+
+std::mutex       rule_mutex_;
+int              rules_ = 0;  // The number of indexes assigned
+std::vector<int> free_rules_; // Indexes released by destroyed rules
+
+} // namespace
+
+
+// Returns an unused rule index.
+int
+acquire_rule_index()
+{
+  std::lock_guard<std::mutex> lock(rule_mutex_);
+  if (free_rules_.empty())
+    return rules_++;
+  int n = free_rules_.back();
+  free_rules_.pop_back();
+  return n;
+}
+
+
+// Release the index of a destroyed rule.
+void
+release_rule_index(int n)
+{
+  std::lock_guard<std::mutex> lock(rule_mutex_);
+  free_rules_.push_back(n);
+}
+
+
+// Initialize the state with the tokens remaining in `ts`. The
+// spelling function is used to diagnose errors, and the flag
+// determines whether rules are memoized.
+Parse_state::Parse_state(Token_stream& ts, Token_spelling spell, bool memo)
+  : ts_(ts), first_(ts.position()), toks_(first_, ts.buf_.end()),
+    pos_(0), spell_(spell), memo_(memo), far_(-1)
+{ }
+
+
+// Returns the location of the current token. At the end of
+// input, this is the location just past the last token.
+Location
+Parse_state::location() const
+{
+  if (!eof())
+    return toks_[pos_].location();
+  if (!toks_.empty()) {
+    Token const& t = toks_.back();
+    Location loc = t.location();
+    return Location(loc.buffer(), loc.offset() + t.spelling().size());
+  }
+  return Location();
+}
+
+
+// Advance the token stream past the tokens that have been
+// consumed.
+void
+Parse_state::commit()
+{
+  Token_stream::Position p = first_;
+  std::advance(p, pos_);
+  ts_.reposition(p);
+}
+
+
+// Record the expectations of a failure at the current position.
+// Only the failures at the furthest position are kept.
+void
+Parse_state::expect(Expectation e)
+{
+  if (pos_ > far_) {
+    far_ = pos_;
+    exp_.clear();
+  }
+  if (pos_ < far_)
+    return;
+  for (Expectation const& x : exp_)
+    if (x.kind == e.kind && x.name == e.name)
+      return;
+  exp_.push_back(e);
+}
+
+
+// Record that the rule named `n` was expected. This replaces
+// the tokens expected at the current position, since the rule
+// describes them.
+void
+Parse_state::expected(char const* n)
+{
+  if (pos_ == far_)
+    exp_.clear();
+  expect({invalid_tok, n});
+}
+
+
+// Emit an error describing the furthest failure.
+void
+Parse_state::diagnose()
+{
+  int pos = pos_;
+  if (far_ > pos_)
+    pos_ = far_;
+
+  String msg = "expected ";
+  for (std::size_t i = 0; i < exp_.size(); ++i) {
+    if (i != 0)
+      msg += i + 1 == exp_.size() ? " or " : ", ";
+    if (exp_[i].name)
+      msg += exp_[i].name;
+    else if (spell_)
+      msg += format("'{}'", spell_(exp_[i].kind));
+    else
+      msg += format("token {}", exp_[i].kind);
+  }
+  if (exp_.empty())
+    msg = "unexpected token";
+  if (eof())
+    msg += " but got end-of-file";
+  else
+    msg += format(" but got '{}'", peek().spelling());
+  error(location(), msg);
+
+  pos_ = pos;
+}
+
+
+} // namespace lingo
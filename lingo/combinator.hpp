@@ -0,0 +1,566 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_COMBINATOR_HPP
+#define LINGO_COMBINATOR_HPP
+
+// The combinator module provides a library for building parsers
+// from smaller parsers. A grammar is written as a set of rules,
+// each defined by a parsing expression:
+//
+//    Rule<Expr const*> primary("primary-expression");
+//    Rule<Expr const*> sum("additive-expression");
+//
+//    primary = alt(sequence(on_int, tok(integer_tok)),
+//                  sequence(on_paren, tok(lparen_tok), sum, tok(rparen_tok)));
+//    sum = chain_left(primary, one_of(plus_tok, minus_tok), on_binary);
+//
+// and a sequence of tokens is parsed by applying a rule to a
+// parse state:
+//
+//    Parse_state s(ts, get_spelling);
+//    Expr const* e = sum(s);
+//
+// A parser is a function object that takes a parse state and
+// returns its result, which must be default constructible and
+// contextually convertible to bool. A result that converts to
+// false denotes failure (e.g., an invalid token or a null
+// pointer). A parser that fails leaves the parse state at the
+// position where it started, so alternatives can be tried in
+// order (i.e., the grammar is a parsing expression grammar).
+//
+// Backtracking can require exponential time. To avoid that, the
+// parse state saves the result of applying each rule at each token
+// position (i.e., packrat parsing), so that each rule is applied
+// at most once at any position and parsing takes linear time.
+// Rules themselves are not modified by parsing, so a grammar can
+// be shared by parse states.
+// A rule that refers to itself at the same position (i.e., it
+// is left recursive) fails instead of looping. Use chain_left()
+// for left-associative operators.
+//
+// When parsing fails, the state records the furthest position
+// reached and what was expected there, which is reported by
+// diagnose().
+
+#include <lingo/token.hpp>
+#include <lingo/error.hpp>
+
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Parse state
+
+// A function that returns the spelling of a token kind.
+using Token_spelling = char const* (*)(int);
+
+
+// The parse state is a random-access view of a token stream
+// along with the information needed to diagnose errors and to
+// memoize rules. When parsing finishes, the token stream should
+// be repositioned to the end of the parsed text by calling
+// commit(). A parse state shall not outlive the rules applied
+// to it.
+class Parse_state
+{
+public:
+  // The saved result of applying a rule at a position. When
+  // the end is unknown, the rule has not been applied.
+  template<typename T>
+  struct Memo
+  {
+    static constexpr int unknown = -2;
+    static constexpr int failed = -1;
+
+    Memo()
+      : end(unknown), value()
+    { }
+
+    int end;
+    T   value;
+  };
+
+  Parse_state(Token_stream&, Token_spelling = nullptr, bool = true);
+
+  // Returns true if rules are memoized.
+  bool memoizing() const { return memo_; }
+
+  // Returns the saved result of the rule with the given index
+  // at a position.
+  template<typename T>
+  Memo<T>& memo(int, int);
+
+  // Returns the number of tokens.
+  int size() const { return toks_.size(); }
+
+  // Stream position.
+  int  position() const   { return pos_; }
+  void reposition(int n)  { pos_ = n; }
+
+  bool  eof() const;
+  Token peek() const;
+  Token get();
+
+  Location location() const;
+
+  void commit();
+
+  // Failure reporting.
+  void expected(int);
+  void expected(char const*);
+  void diagnose();
+
+private:
+  struct Expectation
+  {
+    int         kind; // The expected token kind
+    char const* name; // Or the expected rule
+  };
+
+  // The saved results of a rule, indexed by token position.
+  struct Memo_table
+  {
+    virtual ~Memo_table() { }
+  };
+
+  template<typename T>
+  struct Memo_table_of : Memo_table
+  {
+    explicit Memo_table_of(int n)
+      : entries(n)
+    { }
+
+    std::vector<Memo<T>> entries;
+  };
+
+  void expect(Expectation);
+
+  Token_stream&                            ts_;
+  Token_stream::Position                   first_; // Where parsing began
+  std::vector<Token>                       toks_;
+  int                                      pos_;
+  Token_spelling                           spell_;
+  bool                                     memo_;
+  int                                      far_;   // The furthest failure
+  std::vector<Expectation>                 exp_;   // Expected at the furthest failure
+  std::vector<std::unique_ptr<Memo_table>> memos_; // Indexed by rule
+};
+
+
+// Returns the saved result of the rule with index `r` at the
+// position `n`. The table for a rule is allocated when the rule
+// is first applied and is never resized, so the result stays
+// valid while other rules are applied.
+template<typename T>
+inline Parse_state::Memo<T>&
+Parse_state::memo(int r, int n)
+{
+  if (r >= (int)memos_.size())
+    memos_.resize(r + 1);
+  if (!memos_[r])
+    memos_[r].reset(new Memo_table_of<T>(toks_.size() + 1));
+  return static_cast<Memo_table_of<T>&>(*memos_[r]).entries[n];
+}
+
+
+// Record that a token of kind `k` was expected. Failures before
+// the furthest failure are ignored.
+inline void
+Parse_state::expected(int k)
+{
+  if (pos_ >= far_)
+    expect({k, nullptr});
+}
+
+
+// Returns true if all tokens have been consumed.
+inline bool
+Parse_state::eof() const
+{
+  return pos_ == (int)toks_.size();
+}
+
+
+// Returns the current token, or an invalid token at the end
+// of input.
+inline Token
+Parse_state::peek() const
+{
+  if (eof())
+    return Token();
+  return toks_[pos_];
+}
+
+
+// Returns the current token and advances the state.
+inline Token
+Parse_state::get()
+{
+  if (eof())
+    return Token();
+  return toks_[pos_++];
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Rules
+
+int  acquire_rule_index();
+void release_rule_index(int);
+
+
+// A rule is a named, possibly recursive, parser. Rules are
+// not copyable; combinators refer to rules, so that a rule can
+// be used before it is defined. When a rule is first defined,
+// it is given an index that identifies its results in a parse
+// state. The indexes of destroyed rules are reused, so that
+// they remain small.
+template<typename T>
+class Rule
+{
+public:
+  using result_type = T;
+
+  explicit Rule(char const* name = nullptr)
+    : name_(name), index_(-1)
+  { }
+
+  ~Rule();
+
+  Rule(Rule const&) = delete;
+
+  // Rules are defined by assignment. Assigning a rule defines
+  // this rule as a reference to that rule.
+  Rule& operator=(Rule const&);
+
+  template<typename P>
+  Rule& operator=(P const&);
+
+  // Returns the name of the rule, if any.
+  char const* name() const { return name_; }
+
+  T operator()(Parse_state&) const;
+
+private:
+  using Memo = Parse_state::Memo<T>;
+
+  void define();
+  T    apply(Parse_state&) const;
+
+  char const*                    name_;
+  int                            index_;
+  std::function<T(Parse_state&)> def_;
+};
+
+
+// A reference to a rule.
+template<typename T>
+struct Rule_ref
+{
+  using result_type = T;
+
+  T operator()(Parse_state& s) const { return (*rule)(s); }
+
+  Rule<T> const* rule;
+};
+
+
+// Returns the parser `p`, or a reference to `p` if it is a rule.
+template<typename P>
+inline P const&
+as_parser(P const& p)
+{
+  return p;
+}
+
+
+template<typename T>
+inline Rule_ref<T>
+as_parser(Rule<T> const& r)
+{
+  return {&r};
+}
+
+
+// The type of parser returned by as_parser().
+template<typename P>
+using Parser_type = typename std::decay<decltype(as_parser(std::declval<P const&>()))>::type;
+
+
+template<typename T>
+inline
+Rule<T>::~Rule()
+{
+  if (index_ >= 0)
+    release_rule_index(index_);
+}
+
+
+// Assign an index to the rule when it is first defined.
+template<typename T>
+inline void
+Rule<T>::define()
+{
+  if (index_ < 0)
+    index_ = acquire_rule_index();
+}
+
+
+// Define the rule as the rule `r`.
+template<typename T>
+inline Rule<T>&
+Rule<T>::operator=(Rule const& r)
+{
+  define();
+  def_ = Rule_ref<T>{&r};
+  return *this;
+}
+
+
+// Define the rule as the parser `p`.
+template<typename T>
+template<typename P>
+inline Rule<T>&
+Rule<T>::operator=(P const& p)
+{
+  define();
+  def_ = as_parser(p);
+  return *this;
+}
+
+
+// Apply the rule without memoization.
+template<typename T>
+inline T
+Rule<T>::apply(Parse_state& s) const
+{
+  int start = s.position();
+  T result = def_(s);
+  if (!result && name_ && s.position() == start)
+    s.expected(name_);
+  return result;
+}
+
+
+// Apply the rule at the current position. If the state is
+// memoizing, the result is saved in the state, and subsequent
+// applications at the same position return that result.
+template<typename T>
+T
+Rule<T>::operator()(Parse_state& s) const
+{
+  if (!s.memoizing())
+    return apply(s);
+
+  int start = s.position();
+  Memo& m = s.memo<T>(index_, start);
+  if (m.end == Memo::failed)
+    return T();
+  if (m.end != Memo::unknown) {
+    s.reposition(m.end);
+    return m.value;
+  }
+
+  // Mark the rule as failed while applying it, so that
+  // a left recursive application fails.
+  m.end = Memo::failed;
+  T result = apply(s);
+  if (result) {
+    m.end = s.position();
+    m.value = result;
+  }
+  return result;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Tokens
+
+// Matches any of the given token kinds.
+struct Token_parser
+{
+  using result_type = Token;
+
+  Token operator()(Parse_state&) const;
+
+  std::vector<int> kinds;
+};
+
+
+inline Token
+Token_parser::operator()(Parse_state& s) const
+{
+  int k = s.peek().kind();
+  for (int x : kinds) {
+    if (k == x)
+      return s.get();
+  }
+  for (int x : kinds)
+    s.expected(x);
+  return Token();
+}
+
+
+// Returns a parser that matches a token of kind `k`.
+inline Token_parser
+tok(int k)
+{
+  return {{k}};
+}
+
+
+// Returns a parser that matches a token of any of the
+// given kinds.
+template<typename... Ks>
+inline Token_parser
+one_of(Ks... ks)
+{
+  return {{int(ks)...}};
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Sequences
+
+// Matches each parser in turn, then returns the result of
+// calling a function with their results.
+template<typename F, typename... Ps>
+struct Sequence_parser
+{
+  using result_type = typename std::result_of<F(typename Ps::result_type...)>::type;
+
+  result_type operator()(Parse_state& s) const
+  {
+    int start = s.position();
+    result_type r = parse(s, std::index_sequence_for<Ps...>());
+    if (!r)
+      s.reposition(start);
+    return r;
+  }
+
+  template<std::size_t... Is>
+  result_type parse(Parse_state& s, std::index_sequence<Is...>) const
+  {
+    std::tuple<typename Ps::result_type...> rs;
+    bool ok = true;
+    // Parse each element in order, stopping at the first failure.
+    using expand = int[];
+    (void)expand{0, (ok = ok && (std::get<Is>(rs) = std::get<Is>(ps)(s)), 0)...};
+    if (!ok)
+      return result_type();
+    return fn(std::get<Is>(rs)...);
+  }
+
+  F                 fn;
+  std::tuple<Ps...> ps;
+};
+
+
+// Returns a parser that matches each of the parsers `ps` in
+// order and returns `fn` applied to their results. If any
+// parser fails, the sequence fails without calling `fn`.
+template<typename F, typename... Ps>
+inline Sequence_parser<F, Parser_type<Ps>...>
+sequence(F fn, Ps const&... ps)
+{
+  return {fn, std::tuple<Parser_type<Ps>...>(as_parser(ps)...)};
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Alternatives
+
+// Returns the result of the first of the parsers that matches.
+template<typename... Ps>
+struct Alternative_parser
+{
+  using result_type = typename std::common_type<typename Ps::result_type...>::type;
+
+  result_type operator()(Parse_state& s) const
+  {
+    return parse(s, std::index_sequence_for<Ps...>());
+  }
+
+  template<std::size_t... Is>
+  result_type parse(Parse_state& s, std::index_sequence<Is...>) const
+  {
+    result_type r = result_type();
+    using expand = int[];
+    (void)expand{0, (r = r ? r : result_type(std::get<Is>(ps)(s)), 0)...};
+    return r;
+  }
+
+  std::tuple<Ps...> ps;
+};
+
+
+// Returns a parser that tries each of the parsers `ps` in
+// order, returning the result of the first that matches.
+template<typename... Ps>
+inline Alternative_parser<Parser_type<Ps>...>
+alt(Ps const&... ps)
+{
+  return {std::tuple<Parser_type<Ps>...>(as_parser(ps)...)};
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Operators
+
+// Matches a sequence of operands separated by operators and
+// combines them from left to right.
+template<typename P, typename O, typename F>
+struct Chain_parser
+{
+  using result_type = typename P::result_type;
+
+  result_type operator()(Parse_state& s) const
+  {
+    result_type e1 = operand(s);
+    if (!e1)
+      return e1;
+    while (true) {
+      int pos = s.position();
+      auto op = oper(s);
+      if (!op)
+        break;
+      result_type e2 = operand(s);
+      if (!e2) {
+        s.reposition(pos);
+        break;
+      }
+      e1 = fn(op, e1, e2);
+    }
+    return e1;
+  }
+
+  P operand;
+  O oper;
+  F fn;
+};
+
+
+// Returns a parser that matches
+//
+//    operand (op operand)*
+//
+// combining operands from left to right by calling `fn(op, e1, e2)`.
+template<typename P, typename O, typename F>
+inline Chain_parser<Parser_type<P>, Parser_type<O>, F>
+chain_left(P const& operand, O const& op, F fn)
+{
+  return {as_parser(operand), as_parser(op), fn};
+}
+
+
+} // namespace lingo
+
+#endif
@@ -0,0 +1,43 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/driver.hpp"
+#include "lingo/trace.hpp"
+
+#include <exception>
+
+namespace lingo
+{
+
+// Open the file and translate it by calling `fn`, saving the
+// diagnostics that are emitted.
+void
+process_file(File_status& s, std::function<void(File&)> const& fn)
+{
+  lingo_trace_scope("process file");
+  Diagnostic_context diags(true);
+  try {
+    s.file = &file_manager().open(s.path);
+    fn(*s.file);
+  } catch (std::exception& err) {
+    error(Location(), String(err.what()));
+  }
+  s.diagnostics = diags.diagnostics();
+  s.errors = diags.errors();
+}
+
+
+// Emit the diagnostics of the file in the active diagnostic
+// context. Returns the number of errors.
+int
+report_diagnostics(File_status const& s)
+{
+  for (Diagnostic const& diag : s.diagnostics)
+    emit_diagnostic(diag);
+  return s.errors;
+}
+
+
+} // namespace lingo
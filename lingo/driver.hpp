@@ -0,0 +1,129 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_DRIVER_HPP
+#define LINGO_DRIVER_HPP
+
+// The driver module translates several input files in parallel.
+// A language supplies a function that translates a single file
+// (e.g., by lexing, parsing, and checking it) and returns its
+// result:
+//
+//    Expr const*
+//    translate(File& f)
+//    {
+//      ...
+//      return expr;
+//    }
+//
+//    std::vector<File_result<Expr const*>> files = process_files(paths, translate);
+//    if (report_diagnostics(files))
+//      return 1;
+//    for (File_result<Expr const*> const& f : files)
+//      evaluate(f.result);
+//
+// Each file is opened through the file manager and translated
+// by a task on the scheduler. Files are loaded asynchronously in
+// the order given, so that reading later files overlaps with
+// translating earlier ones. The diagnostics emitted while
+// translating a file are saved rather than printed, so that
+// they can be reported in the order that the files were given,
+// regardless of the order in which they were translated.
+//
+// The translation function is called concurrently for different
+// files, so any state that it shares between files must be safe
+// to access from multiple threads.
+
+#include <lingo/file.hpp>
+#include <lingo/error.hpp>
+#include <lingo/scheduler.hpp>
+
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            File results
+
+// The status of a translated file. If the file could not be
+// opened, then `file` is null and the diagnostics report the
+// error.
+struct File_status
+{
+  using Diagnostic_list = Diagnostic_context::Diagnostic_list;
+
+  File_status()
+    : file(nullptr), errors(0)
+  { }
+
+  std::string     path;
+  File*           file;
+  Diagnostic_list diagnostics; // Emitted during translation
+  int             errors;      // The number of errors
+};
+
+
+// The status and result of a translated file. If errors
+// occurred, the result is whatever the translation returned,
+// or a value-initialized object if it threw an exception.
+template<typename T>
+struct File_result : File_status
+{
+  File_result()
+    : result()
+  { }
+
+  T result;
+};
+
+
+void process_file(File_status&, std::function<void(File&)> const&);
+int  report_diagnostics(File_status const&);
+
+
+// -------------------------------------------------------------------------- //
+//                            Processing files
+
+// Translate each of the files in `paths` by calling `fn` on the
+// opened file, in parallel. Results are returned in the order of
+// `paths`. Exceptions thrown by `fn` are reported as errors of
+// the file being translated.
+template<typename F>
+auto
+process_files(std::vector<std::string> const& paths, F fn, Scheduler& s = scheduler())
+  -> std::vector<File_result<typename std::result_of<F(File&)>::type>>
+{
+  using Result = File_result<typename std::result_of<F(File&)>::type>;
+  std::vector<Result> files(paths.size());
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    files[i].path = paths[i];
+    file_manager().open_async(paths[i]);
+  }
+  parallel_for(0, files.size(), [&files, &fn](std::size_t i) {
+    Result& r = files[i];
+    process_file(r, [&r, &fn](File& f) { r.result = fn(f); });
+  }, 1, s);
+  return files;
+}
+
+
+// Emit the diagnostics of each file, in order, in the active
+// diagnostic context. Returns the total number of errors.
+template<typename T>
+int
+report_diagnostics(std::vector<File_result<T>> const& files)
+{
+  int n = 0;
+  for (File_result<T> const& f : files)
+    n += report_diagnostics(f);
+  return n;
+}
+
+
+} // namespace lingo
+
+#endif
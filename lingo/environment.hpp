@@ -4,7 +4,10 @@
 #ifndef LINGO_ENVIRONMENT_HPP
 #define LINGO_ENVIRONMENT_HPP
 
+#include <lingo/symbol.hpp>
+
 #include <cassert>
+#include <deque>
 #include <unordered_map>
 #include <vector>
 
@@ -233,6 +236,147 @@ Stack<E>::lookup(Name_type const& n) -> Binding*
 }
 
 
+// -------------------------------------------------------------------------- //
+// Binding slots
+
+// A binding of a symbol in a slot stack. Like the bindings of
+// an environment, the name and value are `first` and `second`.
+// Each binding also refers to the binding that it shadows, and
+// records the depth of the scope in which it was made.
+template<typename T>
+struct Slot_binding
+{
+  Symbol const* first;
+  T             second;
+  Slot_binding* shadowed; // The next outer binding of the symbol
+  std::size_t   scope;    // The scope index (0 is the outermost)
+};
+
+
+// A slot stack maintains nested scopes of symbol bindings like a
+// stack of environments, but each symbol has a slot (indexed by
+// its id) that refers to its innermost binding. Lookup reads the
+// slot instead of searching each scope. Bindings are kept on a
+// trail in the order they were made. When a scope is popped, the
+// bindings it introduced are removed from the trail, and their
+// slots are restored to the bindings they shadowed. Lookup takes
+// constant time, and popping a scope takes time proportional to
+// the number of bindings it introduced.
+//
+// The stack supports the push(), pop(), bind(), rebind(),
+// lookup(), and size() operations of Stack. Unlike Stack, the
+// scopes are not environments, so they cannot be taken from the
+// stack or inspected individually.
+//
+// All symbols bound in a slot stack shall belong to the same
+// symbol table.
+template<typename T>
+class Slot_stack
+{
+public:
+  using Name_type = Symbol const*;
+  using Value_type = T;
+  using Binding = Slot_binding<T>;
+
+  void push();
+  void pop();
+
+  Binding& bind(Symbol const*, T const&);
+  Binding& rebind(Symbol const*, T const&);
+
+  Binding const* lookup(Symbol const*) const;
+  Binding*       lookup(Symbol const*);
+
+  // Returns the number of scopes.
+  std::size_t size() const { return scopes_.size(); }
+
+  // Returns true if there are no scopes.
+  bool empty() const { return scopes_.empty(); }
+
+private:
+  std::vector<Binding*>    slots_;  // Innermost bindings, by symbol id
+  std::deque<Binding>      trail_;  // Bindings in order of creation
+  std::vector<std::size_t> scopes_; // Trail size at each scope entry
+};
+
+
+// Enter a new scope.
+template<typename T>
+inline void
+Slot_stack<T>::push()
+{
+  scopes_.push_back(trail_.size());
+}
+
+
+// Leave the current scope, restoring the bindings shadowed by
+// those made in it.
+template<typename T>
+inline void
+Slot_stack<T>::pop()
+{
+  assert(!scopes_.empty());
+  std::size_t n = scopes_.back();
+  while (trail_.size() > n) {
+    Binding& b = trail_.back();
+    slots_[b.first->id()] = b.shadowed;
+    trail_.pop_back();
+  }
+  scopes_.pop_back();
+}
+
+
+// Create a new name binding in the current scope. Behavior is
+// undefined if the symbol is already bound in this scope.
+template<typename T>
+inline auto
+Slot_stack<T>::bind(Symbol const* sym, T const& val) -> Binding&
+{
+  assert(!scopes_.empty());
+  std::size_t id = sym->id();
+  if (id >= slots_.size())
+    slots_.resize(id + 1);
+  Binding*& slot = slots_[id];
+  assert(!slot || slot->scope != scopes_.size() - 1);
+  trail_.push_back({sym, val, slot, scopes_.size() - 1});
+  slot = &trail_.back();
+  return *slot;
+}
+
+
+// Overwrite the binding of a symbol in the current scope.
+// Behavior is undefined if the binding does not exist.
+template<typename T>
+inline auto
+Slot_stack<T>::rebind(Symbol const* sym, T const& val) -> Binding&
+{
+  Binding* b = lookup(sym);
+  assert(b && b->scope == scopes_.size() - 1);
+  b->second = val;
+  return *b;
+}
+
+
+// Returns the innermost binding of the symbol, or null if the
+// symbol is unbound.
+template<typename T>
+inline auto
+Slot_stack<T>::lookup(Symbol const* sym) const -> Binding const*
+{
+  std::size_t id = sym->id();
+  return id < slots_.size() ? slots_[id] : nullptr;
+}
+
+
+template<typename T>
+inline auto
+Slot_stack<T>::lookup(Symbol const* sym) -> Binding*
+{
+  std::size_t id = sym->id();
+  return id < slots_.size() ? slots_[id] : nullptr;
+}
+
+
 } // namespace lingo
 
 #endif
@@ -135,13 +135,22 @@ operator<<(std::ostream& os, Diagnostic const& diag)
 namespace
 {
 
-// The diagnostic stack.
-std::stack<Diagnostic_context*> diags_;
+// The diagnostic stack of this thread.
+thread_local std::stack<Diagnostic_context*> diags_;
 
 
-// The root diagnostic context. Note that this self-registers
-// as the top diagnostic context.
-Diagnostic_context root_;
+// Returns the active diagnostic context of this thread. When
+// no context has been declared, the root context of the thread
+// is active. Note that the root context self-registers as the
+// top diagnostic context when it is created.
+Diagnostic_context*
+active_context()
+{
+  if (diags_.empty()) {
+    thread_local Diagnostic_context root_;
+  }
+  return diags_.top();
+}
 
 
 } // namespace
@@ -158,7 +167,7 @@ Diagnostic::Diagnostic(Diagnostic_kind k, Span s, String const& m)
 
 
 Diagnostic_context::Diagnostic_context(bool suppress)
-  : suppress_(suppress), errs_(0)
+  : suppress_(suppress), errs_(0), spec_(0)
 {
   diags_.push(this);
 }
@@ -171,13 +180,13 @@ Diagnostic_context::~Diagnostic_context()
 
 
 // Emit a single diagnostic. If this context is suppressing
-// diagnostics, then save them for later.
+// diagnostics or speculating, then save them for later.
 void
 Diagnostic_context::emit(Diagnostic const& diag)
 {
   if (diag.kind == error_diag)
     ++ errs_;
-  if (suppress_)
+  if (suppress_ || spec_)
     push_back(diag);
   else
     std::cerr << diag;
@@ -193,6 +202,44 @@ Diagnostic_context::reset()
 }
 
 
+// Begin speculating, returning a mark for the diagnostics
+// emitted so far.
+Diagnostic_mark
+Diagnostic_context::mark()
+{
+  ++spec_;
+  return {this, size(), errs_};
+}
+
+
+// Discard the diagnostics emitted since the mark `m` and
+// restore the error count. Only the discarded diagnostics are
+// destroyed.
+void
+Diagnostic_context::rollback(Diagnostic_mark const& m)
+{
+  lingo_assert(m.context == this && spec_ > 0);
+  erase(begin() + m.size, end());
+  errs_ = m.errs;
+  --spec_;
+}
+
+
+// Keep the diagnostics emitted since the mark `m`. When the
+// outermost mark is committed, and diagnostics are not being
+// suppressed, the saved diagnostics are printed.
+void
+Diagnostic_context::commit(Diagnostic_mark const& m)
+{
+  lingo_assert(m.context == this && spec_ > 0);
+  if (--spec_ == 0 && !suppress_) {
+    for (auto i = begin() + m.size; i != end(); ++i)
+      std::cerr << *i;
+    erase(begin() + m.size, end());
+  }
+}
+
+
 // Emit all saved diagnostics. This does nothing if
 // the context is not suppressing diagnostics.
 void
@@ -209,7 +256,7 @@ Diagnostic_context::emit()
 void
 emit_diagnostics()
 {
-  diags_.top()->emit();
+  active_context()->emit();
 }
 
 
@@ -217,7 +264,7 @@ emit_diagnostics()
 void
 reset_diagnostics()
 {
-  diags_.top()->reset();
+  active_context()->reset();
 }
 
 
@@ -226,7 +273,39 @@ reset_diagnostics()
 int
 error_count()
 {
-  return diags_.top()->errors();
+  return active_context()->errors();
+}
+
+
+// Begin speculating in the current diagnostic context.
+Diagnostic_mark
+mark_diagnostics()
+{
+  return active_context()->mark();
+}
+
+
+// Discard the diagnostics emitted since the mark `m`.
+void
+rollback_diagnostics(Diagnostic_mark const& m)
+{
+  m.context->rollback(m);
+}
+
+
+// Keep the diagnostics emitted since the mark `m`.
+void
+commit_diagnostics(Diagnostic_mark const& m)
+{
+  m.context->commit(m);
+}
+
+
+// Emit the diagnostic in the active diagnostic context.
+void
+emit_diagnostic(Diagnostic const& diag)
+{
+  active_context()->emit(diag);
 }
 
 
@@ -234,7 +313,7 @@ error_count()
 void
 error(Location loc, String const& msg)
 {
-  diags_.top()->emit({error_diag, loc, msg});
+  active_context()->emit({error_diag, loc, msg});
 }
 
 
@@ -242,7 +321,7 @@ error(Location loc, String const& msg)
 void
 error(Span span, String const& msg)
 {
-  diags_.top()->emit({error_diag, span, msg});
+  active_context()->emit({error_diag, span, msg});
 }
 
 
@@ -253,7 +332,7 @@ error(Span span, String const& msg)
 void
 warning(Location loc, String const& msg)
 {
-  diags_.top()->emit({warning_diag, loc, msg});
+  active_context()->emit({warning_diag, loc, msg});
 }
 
 
@@ -261,7 +340,7 @@ warning(Location loc, String const& msg)
 void
 warning(Span span, String const& msg)
 {
-  diags_.top()->emit({warning_diag, span, msg});
+  active_context()->emit({warning_diag, span, msg});
 }
 
 
@@ -272,14 +351,14 @@ warning(Span span, String const& msg)
 void
 note(Location loc, String const& msg)
 {
-  diags_.top()->emit({note_diag, loc, msg});
+  active_context()->emit({note_diag, loc, msg});
 }
 
 
 void
 note(Span span, String const& msg)
 {
-  diags_.top()->emit({note_diag, span, msg});
+  active_context()->emit({note_diag, span, msg});
 }
 
 
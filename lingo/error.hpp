@@ -10,6 +10,7 @@
 #include <lingo/location.hpp>
 #include <lingo/buffer.hpp>
 #include <lingo/print.hpp>
+#include <lingo/accounting.hpp>
 
 #include <cstdio>
 #include <string>
@@ -95,6 +96,20 @@ struct Diagnostic
 };
 
 
+class Diagnostic_context;
+
+
+// A position in the diagnostics of a context. Diagnostics
+// emitted after a mark can be discarded by rolling back to it.
+// Note that the mark does not copy any diagnostics.
+struct Diagnostic_mark
+{
+  Diagnostic_context* context;
+  std::size_t         size; // Number of saved diagnostics
+  int                 errs; // Number of errors
+};
+
+
 // A diagnostic context is a record of all diagnostic messages that
 // have been emitted as part some processing phase.
 //
@@ -103,10 +118,21 @@ struct Diagnostic
 //
 // When a diagnostic context is declared (as a variable), it becomes
 // the active diagnostic context. When the declaration goes out of
-// scope, the previous context becomes active.
-class Diagnostic_context : std::vector<Diagnostic>
+// scope, the previous context becomes active. Each thread has its
+// own stack of diagnostic contexts, so a context declared in one
+// thread does not collect diagnostics emitted by others.
+//
+// Diagnostics are also saved while the context is speculating
+// (i.e., between a call to mark() and the matching rollback()
+// or commit()). Rolling back discards the diagnostics emitted
+// since the mark. Committing the outermost mark of a context
+// that is not suppressing diagnostics prints them.
+class Diagnostic_context
+  : std::vector<Diagnostic, Accounting_allocator<Diagnostic, diagnostic_memory>>
 {
 public:
+  using Diagnostic_list = std::vector<Diagnostic, Accounting_allocator<Diagnostic, diagnostic_memory>>;
+
   Diagnostic_context(bool = false);
   ~Diagnostic_context();
 
@@ -115,6 +141,13 @@ public:
 
   void reset();
 
+  Diagnostic_mark mark();
+  void            rollback(Diagnostic_mark const&);
+  void            commit(Diagnostic_mark const&);
+
+  // Returns true if the context is speculating.
+  bool speculating() const { return spec_ != 0; }
+
   // Returns true if diagnostics are suppressed.
   bool quiet() const { return !suppress_; }
 
@@ -124,9 +157,13 @@ public:
   // Returns the number of errors.
   int errors() const { return errs_; }
 
+  // Returns the saved diagnostics.
+  Diagnostic_list const& diagnostics() const { return *this; }
+
 private:
   bool suppress_; // True if diagnostics are temporarily suppressed.
   int  errs_;     // Actual error count.
+  int  spec_;     // Number of open marks.
 };
 
 
@@ -137,6 +174,12 @@ void emit_diagnostics();
 void reset_diagnostics();
 int error_count();
 
+Diagnostic_mark mark_diagnostics();
+void            rollback_diagnostics(Diagnostic_mark const&);
+void            commit_diagnostics(Diagnostic_mark const&);
+
+void emit_diagnostic(Diagnostic const&);
+
 void error(Location, String const&);
 void error(Span, String const&);
 
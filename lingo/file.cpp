@@ -5,9 +5,18 @@
 
 #include "lingo/file.hpp"
 #include "lingo/error.hpp"
+#include "lingo/trace.hpp"
 
+#include <condition_variable>
 #include <fstream>
 #include <iterator>
+#include <memory>
+#include <thread>
+
+#if HAVE_POSIX_FADVISE
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
 
 namespace lingo
 {
@@ -19,6 +28,7 @@ namespace
 String
 read_file(Path const& p)
 {
+  lingo_trace_scope("read file");
   std::ifstream f(p.native());
 
   String text;
@@ -33,6 +43,22 @@ read_file(Path const& p)
   return text;
 }
 
+
+// Advise the operating system that the file will be read
+// soon, so that it can begin reading the file ahead of time.
+void
+advise(Path const& p)
+{
+#if HAVE_POSIX_FADVISE
+  int fd = ::open(p.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+  posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+  ::close(fd);
+#endif
+}
+
+
 } // namespace
 
 
@@ -65,31 +91,239 @@ file_manager()
 }
 
 
+// -------------------------------------------------------------------------- //
+// File loader
+
+// The loader reads files on a fixed set of threads. Reading is
+// dominated by waiting on the disk, so these threads are not
+// part of the scheduler's pool.
+class File_manager::Loader
+{
+public:
+  Loader(File_manager&, int);
+  ~Loader();
+
+  void push(Path const&, std::promise<File&>);
+
+private:
+  struct Job
+  {
+    Path                path;
+    std::promise<File&> promise;
+  };
+
+  void work();
+
+  File_manager&            fm_;
+  std::deque<Job>          jobs_;
+  std::vector<std::thread> threads_;
+  std::mutex               mutex_;
+  std::condition_variable  ready_;
+  bool                     stop_;
+};
+
+
+File_manager::Loader::Loader(File_manager& fm, int n)
+  : fm_(fm), stop_(false)
+{
+  for (int i = 0; i < n; ++i)
+    threads_.emplace_back([this]() { work(); });
+}
+
+
+// Stop the loader threads. Files that have not been loaded
+// are abandoned, and their futures report a broken promise.
+File_manager::Loader::~Loader()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  ready_.notify_all();
+  for (std::thread& t : threads_)
+    t.join();
+}
+
+
+void
+File_manager::Loader::push(Path const& p, std::promise<File&> promise)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobs_.push_back({p, std::move(promise)});
+  }
+  ready_.notify_one();
+}
+
+
+void
+File_manager::Loader::work()
+{
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ready_.wait(lock, [this]() { return stop_ || !jobs_.empty(); });
+      if (stop_)
+        return;
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+    fm_.load(job.path, job.promise);
+  }
+}
+
+
+// -------------------------------------------------------------------------- //
+// File manager
+
+// The number of threads used to load files asynchronously.
+constexpr int loader_threads_ = 2;
+
+
+File_manager::File_manager()
+{ }
+
+
+// Stop the loader before destroying the other members, since
+// its threads may still be loading files into the manager.
+File_manager::~File_manager()
+{
+  loader_.reset();
+}
+
+
 // Open the file at the path indicated by `p`. If the file has already
-// been opened, then do nothing.
+// been opened, then do nothing. If the file is being loaded, wait for
+// it to be loaded.
+//
+// If two threads open the same file at once, both read its text,
+// but only the first to finish is retained.
 File&
 File_manager::open(Path const& p)
 {
+  lingo_trace_scope("open file");
+  std::shared_future<File&> load;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = lookup_.find(p.native());
+    if (iter != lookup_.end())
+      return *files_[iter->second];
+    auto pend = pending_.find(p.native());
+    if (pend != pending_.end())
+      load = pend->second;
+  }
+  if (load.valid())
+    return load.get();
+
   Path real = canonical(p);
-  auto ins = lookup_.insert({p.native(), 0});
+  return insert(p, std::unique_ptr<File>(new File(real)));
+}
+
+
+// Open the file at the path indicated by `p` asynchronously. The
+// returned future holds the file, or the exception thrown when
+// opening it.
+std::shared_future<File&>
+File_manager::open_async(Path const& p)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto iter = lookup_.find(p.native());
+  if (iter != lookup_.end()) {
+    std::promise<File&> done;
+    done.set_value(*files_[iter->second]);
+    return done.get_future().share();
+  }
+  auto pend = pending_.find(p.native());
+  if (pend != pending_.end())
+    return pend->second;
+
+  std::promise<File&> promise;
+  std::shared_future<File&> load = promise.get_future().share();
+  pending_.insert({p.native(), load});
+
+  // Give the advice before queuing the load, so the operating
+  // system can read ahead while the load waits for a thread.
+  // The pending load keeps other threads from queuing it again.
+  lock.unlock();
+  advise(p);
+  lock.lock();
+
+  if (!loader_)
+    loader_.reset(new Loader(*this, loader_threads_));
+  loader_->push(p, std::move(promise));
+  return load;
+}
+
+
+// Add the file to the manager unless another thread added the
+// same file first. Returns the retained file.
+File&
+File_manager::insert(Path const& p, std::unique_ptr<File> file)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto ins = lookup_.insert({p.native(), files_.size()});
   if (ins.second) {
-    File* file = new File(real, files_.size());
-    files_.push_back(file);
-    ins.first->second = file->index();
-    return *file;
-  } else {
-    int n = ins.first->second;
-    return *files_[n];
+    file->index_ = files_.size();
+    files_.push_back(file.release());
   }
+  return *files_[ins.first->second];
+}
+
+
+// Load the file at the path indicated by `p`, and satisfy the
+// promise with the result.
+void
+File_manager::load(Path const& p, std::promise<File&>& promise)
+{
+  lingo_trace_scope("load file");
+  try {
+    Path real = canonical(p);
+    File& file = insert(p, std::unique_ptr<File>(new File(real)));
+    promise.set_value(file);
+  } catch (...) {
+    promise.set_exception(std::current_exception());
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_.erase(p.native());
 }
 
 
 File&
 File_manager::file(int n)
 {
-  lingo_assert(0 <= n && n << files_.size());
+  std::lock_guard<std::mutex> lock(mutex_);
+  lingo_assert(0 <= n && n < (int)files_.size());
   return *files_[n];
 }
 
 
+// -------------------------------------------------------------------------- //
+// File prefetching
+
+File_prefetcher::File_prefetcher(std::vector<Path> const& paths, int n, File_manager& fm)
+  : fm_(fm), paths_(paths), next_(0), ahead_(n < 0 ? 0 : n)
+{
+  while (loads_.size() < ahead_ && loads_.size() < paths_.size())
+    loads_.push_back(fm_.open_async(paths_[loads_.size()]));
+}
+
+
+// Returns the next file, waiting for it to be loaded if needed,
+// and starts loading the file `n` past it. Throws an exception if
+// the file cannot be opened.
+File&
+File_prefetcher::next()
+{
+  lingo_assert(!done());
+  std::size_t ahead = next_ + loads_.size();
+  if (ahead < paths_.size())
+    loads_.push_back(fm_.open_async(paths_[ahead]));
+  std::shared_future<File&> load = loads_.front();
+  loads_.pop_front();
+  ++next_;
+  return load.get();
+}
+
+
 } // namespace lingo
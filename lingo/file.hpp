@@ -9,6 +9,10 @@
 
 #include <lingo/buffer.hpp>
 
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <vector>
 
@@ -60,21 +64,48 @@ private:
 // The file manager provides a facility for globally managing
 // opened files. This effectively maintains a list of opened (note: not
 // open) files and a side-table for efficient path-based lookup.
+//
+// Files may be opened concurrently. The text of a file is read
+// without holding the manager's lock, so that several files
+// can be read in parallel.
+//
+// Files can also be opened asynchronously. The manager advises
+// the operating system that the file will be read soon, so that
+// it can begin reading ahead, and then reads the file on one of
+// a small set of loader threads. Opening a file that is being
+// loaded waits for the load to complete instead of reading the
+// file again.
 class File_manager
 {
 public:
+  File_manager();
+  ~File_manager();
+
   File& open(char const*);
   File& open(std::string const&);
   File& open(Path const&);
 
+  std::shared_future<File&> open_async(Path const&);
+
   File& file(int);
 
 private:
-  using File_list = std::vector<File*>;
-  using File_map  = std::unordered_map<std::string, int>;
-
-  File_list files_;
-  File_map  lookup_;
+  class Loader;
+
+  File& insert(Path const&, std::unique_ptr<File>);
+  void  load(Path const&, std::promise<File&>&);
+
+  using File_list   = std::vector<File*>;
+  using File_map    = std::unordered_map<std::string, int>;
+  using Pending_map = std::unordered_map<std::string, std::shared_future<File&>>;
+
+  // The loader is declared last so that it is destroyed first:
+  // its threads use the other members until they are joined.
+  std::mutex              mutex_;
+  File_list               files_;
+  File_map                lookup_;
+  Pending_map             pending_; // Files being loaded
+  std::unique_ptr<Loader> loader_;  // Created on first use
 };
 
 
@@ -115,6 +146,35 @@ open_file(std::string const& p)
 }
 
 
+// -------------------------------------------------------------------------- //
+// File prefetching
+
+// A file prefetcher opens a sequence of files in order. While
+// one file is being processed, the next `n` files are loaded
+// asynchronously:
+//
+//    File_prefetcher files(paths);
+//    while (!files.done())
+//      process(files.next());
+class File_prefetcher
+{
+public:
+  File_prefetcher(std::vector<Path> const&, int = 4, File_manager& = file_manager());
+
+  // Returns true when all files have been returned.
+  bool done() const { return next_ == paths_.size(); }
+
+  File& next();
+
+private:
+  File_manager&                         fm_;
+  std::vector<Path>                     paths_;
+  std::deque<std::shared_future<File&>> loads_; // Files being loaded, in order
+  std::size_t                           next_;  // The next file to return
+  std::size_t                           ahead_; // Number of files to load ahead
+};
+
+
 } // namespace lingo
 
 #endif
@@ -0,0 +1,69 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/flat.hpp"
+#include "lingo/debug.hpp"
+
+namespace lingo
+{
+
+// Create a flat tree whose node kinds have the given names.
+Flat_tree::Flat_tree(std::vector<String> const& names)
+  : names_(names), begins_(1, 0)
+{
+  lingo_assert(names.size() <= 256);
+}
+
+
+// Add a node of kind `k` at location `loc` whose children
+// are the nodes `kids`, and return its index. The children
+// shall have been added before the node.
+int
+Flat_tree::make(int k, Location loc, std::initializer_list<int> kids)
+{
+  lingo_assert(0 <= k && k < (int)names_.size());
+  int n = kinds_.size();
+  for (int c : kids) {
+    lingo_assert(0 <= c && c < n);
+    children_.push_back(c);
+  }
+  kinds_.push_back(k);
+  locs_.push_back(loc);
+  begins_.push_back(children_.size());
+  return n;
+}
+
+
+// Debug print a flat node through the view that matches
+// its arity.
+void
+debug(Printer& p, Flat_node n)
+{
+  switch (n.arity()) {
+    case 0: {
+      Flat_nullary v {n};
+      debug(p, &v);
+      break;
+    }
+    case 1: {
+      Flat_unary v {n, (*n.tree)[n.tree->child(n.index, 0)]};
+      debug(p, &v);
+      break;
+    }
+    case 2: {
+      Flat_binary v {n, (*n.tree)[n.tree->child(n.index, 0)], (*n.tree)[n.tree->child(n.index, 1)]};
+      debug(p, &v);
+      break;
+    }
+    default: {
+      Flat_kary v {n};
+      debug(p, &v);
+      break;
+    }
+  }
+}
+
+
+} // namespace lingo
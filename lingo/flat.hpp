@@ -0,0 +1,234 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_FLAT_HPP
+#define LINGO_FLAT_HPP
+
+// The flat module stores trees in a struct-of-arrays layout.
+// A node is identified by its index in the tree, and each of its
+// fields is stored in a separate array: the kinds of nodes, their
+// locations, and the indexes of their children. A pass that reads
+// only one field of each node (e.g., counting nodes by kind) scans
+// a single contiguous array instead of following pointers to
+// objects spread across the heap.
+//
+// Nodes are added bottom-up, so the children of a node are added
+// before it. The root of a tree is usually the last node added.
+// Several trees may share a flat tree.
+//
+//    Flat_tree t({"Int", "Add"});
+//    int a = t.make(int_kind, loc);
+//    int b = t.make(int_kind, loc);
+//    int c = t.make(add_kind, loc, {a, b});
+//
+// Flat nodes are used with the generic node algorithms, like
+// debug(), through views that provide the members of the arity
+// concepts (see lingo/node.hpp). A node with no children is viewed
+// as a nullary node, one with one child is unary, one with two
+// children is binary, and others are k-ary. The name of a viewed
+// node is the name of its kind.
+
+#include <lingo/location.hpp>
+#include <lingo/node.hpp>
+#include <lingo/print.hpp>
+#include <lingo/string.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+namespace lingo
+{
+
+class Flat_tree;
+
+
+// -------------------------------------------------------------------------- //
+//                            Flat nodes
+
+// A reference to a node of a flat tree.
+struct Flat_node
+{
+  int      kind() const;
+  Location location() const;
+  int      arity() const;
+
+  Flat_tree const* tree;
+  int              index;
+};
+
+
+// -------------------------------------------------------------------------- //
+//                            Flat trees
+
+// A tree stored in a struct-of-arrays layout. Node kinds are
+// small integers in the range [0, 256), each of which has a
+// name.
+class Flat_tree
+{
+public:
+  using Kind = std::uint8_t;
+
+  explicit Flat_tree(std::vector<String> const&);
+
+  int make(int, Location, std::initializer_list<int> = {});
+
+  // Returns the number of nodes.
+  std::size_t size() const { return kinds_.size(); }
+
+  // Returns the kind of the node `n`.
+  int kind(int n) const { return kinds_[n]; }
+
+  // Returns the location of the node `n`.
+  Location location(int n) const { return locs_[n]; }
+
+  // Returns the number of children of the node `n`.
+  int arity(int n) const { return begins_[n + 1] - begins_[n]; }
+
+  // Returns the ith child of the node `n`.
+  int child(int n, int i) const { return children_[begins_[n] + i]; }
+
+  // Returns the range of children of the node `n`.
+  int const* begin(int n) const { return children_.data() + begins_[n]; }
+  int const* end(int n) const   { return children_.data() + begins_[n + 1]; }
+
+  // Returns the name of the kind `k`.
+  String const& name(int k) const { return names_[k]; }
+
+  // Returns the kinds of all nodes, in order of index.
+  std::vector<Kind> const& kinds() const { return kinds_; }
+
+  // Returns a reference to the node `n`.
+  Flat_node operator[](int n) const { return {this, n}; }
+
+private:
+  std::vector<String>   names_;    // Names of kinds
+  std::vector<Kind>     kinds_;    // Node kinds
+  std::vector<Location> locs_;     // Node locations
+  std::vector<int>      begins_;   // Offsets of children, and a sentinel
+  std::vector<int>      children_; // Indexes of children
+};
+
+
+inline int
+Flat_node::kind() const
+{
+  return tree->kind(index);
+}
+
+
+inline Location
+Flat_node::location() const
+{
+  return tree->location(index);
+}
+
+
+inline int
+Flat_node::arity() const
+{
+  return tree->arity(index);
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Node views
+
+// An iterator over the children of a flat node.
+class Flat_child_iterator
+{
+public:
+  using iterator_category = std::forward_iterator_tag;
+  using value_type        = Flat_node;
+  using difference_type   = std::ptrdiff_t;
+  using pointer           = Flat_node const*;
+  using reference         = Flat_node;
+
+  Flat_child_iterator(Flat_tree const* t, int const* p)
+    : tree_(t), ptr_(p)
+  { }
+
+  Flat_node operator*() const { return {tree_, *ptr_}; }
+
+  Flat_child_iterator& operator++()
+  {
+    ++ptr_;
+    return *this;
+  }
+
+  Flat_child_iterator operator++(int)
+  {
+    Flat_child_iterator i = *this;
+    ++ptr_;
+    return i;
+  }
+
+  bool operator==(Flat_child_iterator const& i) const { return ptr_ == i.ptr_; }
+  bool operator!=(Flat_child_iterator const& i) const { return ptr_ != i.ptr_; }
+
+private:
+  Flat_tree const* tree_;
+  int const*       ptr_;
+};
+
+
+// A view of a flat node with no children.
+struct Flat_nullary
+{
+  Flat_node node;
+};
+
+
+// A view of a flat node with one child.
+struct Flat_unary
+{
+  Flat_node node;
+  Flat_node first;
+};
+
+
+// A view of a flat node with two children.
+struct Flat_binary
+{
+  Flat_node node;
+  Flat_node first;
+  Flat_node second;
+};
+
+
+// A view of a flat node with any number of children.
+struct Flat_kary
+{
+  Flat_child_iterator begin() const { return {node.tree, node.tree->begin(node.index)}; }
+  Flat_child_iterator end() const   { return {node.tree, node.tree->end(node.index)}; }
+
+  Flat_node node;
+};
+
+
+// The names of viewed nodes are the names of their kinds.
+template<typename T>
+inline String
+get_flat_node_name(T const* t)
+{
+  return t->node.tree->name(t->node.kind());
+}
+
+
+inline String get_node_name(Flat_nullary const* t) { return get_flat_node_name(t); }
+inline String get_node_name(Flat_unary const* t)   { return get_flat_node_name(t); }
+inline String get_node_name(Flat_binary const* t)  { return get_flat_node_name(t); }
+inline String get_node_name(Flat_kary const* t)    { return get_flat_node_name(t); }
+
+
+// -------------------------------------------------------------------------- //
+//                            Algorithms
+
+void debug(Printer&, Flat_node);
+
+
+} // namespace lingo
+
+#endif
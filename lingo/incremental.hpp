@@ -0,0 +1,233 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_INCREMENTAL_HPP
+#define LINGO_INCREMENTAL_HPP
+
+// The incremental module supports reparsing a buffer after a
+// small edit without rescanning or reparsing all of it. This
+// is useful when the text is being edited interactively.
+//
+// An edit is applied to a buffer and its token stream by
+// relex(), which rescans only the tokens that overlap the edit.
+// Scanning stops as soon as a new token matches an old token
+// past the edit, since the remaining tokens are unchanged. The
+// result describes the damaged region of the text.
+//
+//    Damage d = relex(buf, ts, {offset, removed, text}, scan);
+//    stmts.damage(d);
+//
+// A reuse table saves subtrees from the previous parse (e.g.,
+// statements) along with the text they span. Damage removes
+// the subtrees that overlap it. When the parser reaches a token
+// at which a saved subtree began, it can take that subtree and
+// skip its tokens instead of parsing them again. The parser
+// saves each subtree for the next parse, then commits the table.
+//
+// Note that the token list is spliced in place, and the tokens
+// following an edit are moved by a linear walk, but their
+// characters are not rescanned.
+
+#include <lingo/buffer.hpp>
+#include <lingo/character.hpp>
+#include <lingo/token.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Edits
+
+// An edit replaces `removed` characters at `offset` with the
+// given text.
+struct Text_edit
+{
+  int    offset;
+  int    removed;
+  String text;
+};
+
+
+// The region of text affected by an edit. The characters in
+// [first, old_last) of the old text were replaced by those in
+// [first, new_last) of the new text. The region is extended to
+// the boundaries of the relexed tokens.
+struct Damage
+{
+  // Returns the change in the offset of text past the region.
+  int delta() const { return new_last - old_last; }
+
+  int first;
+  int old_last;
+  int new_last;
+};
+
+
+// Returns the offset past the last character of the token.
+inline int
+token_end(Token const& tok)
+{
+  return tok.location().offset() + tok.spelling().size();
+}
+
+
+// Apply the edit to the buffer `buf` and update the tokens
+// of `ts`, which shall have been lexed from `buf`. The function
+// `scan` is called with a character stream to get the next
+// token, and returns an invalid token at the end of input. The
+// token stream is repositioned at its first token.
+//
+// Tokens that end where the edit begins are relexed, since the
+// edit may extend them.
+template<typename Scan>
+Damage
+relex(Buffer& buf, Token_stream& ts, Text_edit const& edit, Scan scan)
+{
+  Tokenbuf& toks = ts.buf_;
+  int first = edit.offset;
+  int last = edit.offset + edit.removed;
+  int delta = int(edit.text.size()) - edit.removed;
+  int size = buf.str().size();
+
+  // Find the first token that ends at or after the edit.
+  auto iter = toks.begin();
+  while (iter != toks.end() && token_end(*iter) < first)
+    ++iter;
+  int start = first;
+  if (iter != toks.end())
+    start = std::min(start, iter->location().offset());
+
+  buf.replace(edit.offset, edit.removed, edit.text);
+
+  // Scan until a new token begins where an old token that
+  // followed the edit began.
+  Character_stream cs(buf, start);
+  Tokenbuf fresh;
+  auto old = iter;
+  while (true) {
+    Token tok = scan(cs);
+    if (!tok) {
+      old = toks.end();
+      break;
+    }
+    int pos = tok.location().offset();
+    if (pos >= last + delta) {
+      while (old != toks.end() &&
+             (old->location().offset() < last ||
+              old->location().offset() + delta < pos))
+        ++old;
+      if (old != toks.end() &&
+          old->location().offset() + delta == pos &&
+          old->symbol() == tok.symbol())
+        break;
+    }
+    fresh.push_back(tok);
+  }
+  int old_last = old == toks.end() ? size : old->location().offset();
+
+  // Replace the damaged tokens and move those that follow.
+  toks.erase(iter, old);
+  toks.splice(old, fresh);
+  if (delta) {
+    for (auto i = old; i != toks.end(); ++i)
+      *i = Token(Location(&buf, i->location().offset() + delta), i->symbol());
+  }
+  ts.reposition(toks.begin());
+  return {start, old_last, old_last + delta};
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Reuse tables
+
+// A reuse table holds the subtrees saved by a parse, in order
+// of their position in the text. Each entry records the text
+// spanned by a subtree and its last token.
+template<typename T>
+class Reuse_table
+{
+public:
+  struct Entry
+  {
+    int                    first;    // Offset of the first character
+    int                    last;     // Offset past the last character
+    Token_stream::Position last_tok; // The last token
+    T                      value;
+  };
+
+  void damage(Damage const&);
+
+  Entry* find(int);
+  void   save(Entry&&);
+  void   commit();
+
+  // Returns the number of saved subtrees.
+  std::size_t size() const { return entries_.size(); }
+
+private:
+  std::vector<Entry> entries_; // Saved by the previous parse
+  std::vector<Entry> next_;    // Saved by the current parse
+};
+
+
+// Remove the entries that overlap the damaged region and
+// move those that follow it.
+template<typename T>
+void
+Reuse_table<T>::damage(Damage const& d)
+{
+  auto cmp = [](Entry const& e, int n) { return e.last <= n; };
+  auto first = std::lower_bound(entries_.begin(), entries_.end(), d.first, cmp);
+  auto last = first;
+  while (last != entries_.end() && last->first < d.old_last)
+    ++last;
+  first = entries_.erase(first, last);
+  for (; first != entries_.end(); ++first) {
+    first->first += d.delta();
+    first->last += d.delta();
+  }
+}
+
+
+// Returns the entry for the subtree that began at offset `n`,
+// or null if there is none. The entry may be moved to the
+// next parse by save().
+template<typename T>
+auto
+Reuse_table<T>::find(int n) -> Entry*
+{
+  auto cmp = [](Entry const& e, int n) { return e.first < n; };
+  auto iter = std::lower_bound(entries_.begin(), entries_.end(), n, cmp);
+  if (iter != entries_.end() && iter->first == n)
+    return &*iter;
+  return nullptr;
+}
+
+
+// Save a subtree for the next parse. Subtrees shall be saved
+// in order.
+template<typename T>
+inline void
+Reuse_table<T>::save(Entry&& e)
+{
+  next_.push_back(std::move(e));
+}
+
+
+// Replace the saved subtrees with those of the current parse.
+template<typename T>
+inline void
+Reuse_table<T>::commit()
+{
+  entries_.swap(next_);
+  next_.clear();
+}
+
+
+} // namespace lingo
+
+#endif
@@ -6,6 +6,7 @@
 
 #include <lingo/utility.hpp>
 #include <lingo/string.hpp>
+#include <lingo/accounting.hpp>
 
 #include <map>
 
@@ -48,7 +49,8 @@ public:
 
 // A line map associates an offset in the source code with
 // its underlying line of text.
-struct Line_map : std::map<int, Line>
+struct Line_map
+  : std::map<int, Line, std::less<int>, Accounting_allocator<std::pair<int const, Line>, line_memory>>
 {
   Locus       locus(int) const;
   Line const& line(int) const;
@@ -5,6 +5,7 @@
 
 #include "lingo/memory.hpp"
 #include "lingo/error.hpp"
+#include "lingo/trace.hpp"
 
 namespace lingo
 {
@@ -15,9 +16,42 @@ namespace
 // The garbage collector.
 Collecting_factory gc_;
 
+// The number of node factories created.
+std::atomic<std::uint64_t> factories_(0);
+
+// The current node factory of each thread.
+thread_local Node_factory* nodes_ = nullptr;
+
 } // namespace
 
 
+Node_factory::Node_factory()
+  : id_(++factories_), next_(0)
+{ }
+
+
+Node_factory_scope::Node_factory_scope(Node_factory& f)
+  : prev_(nodes_)
+{
+  nodes_ = &f;
+}
+
+
+Node_factory_scope::~Node_factory_scope()
+{
+  nodes_ = prev_;
+}
+
+
+// Returns the current node factory of this thread, or null if
+// no factory scope is active.
+Node_factory*
+current_node_factory()
+{
+  return nodes_;
+}
+
+
 // Declare a new GC root.
 void
 Collecting_factory::declare(Reach* r)
@@ -77,6 +111,7 @@ Collecting_factory::sweep()
 void
 Collecting_factory::collect()
 {
+  lingo_trace_scope("collect");
   mark();
   sweep();
 }
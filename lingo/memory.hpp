@@ -5,7 +5,10 @@
 #define LINGO_MEMORY_HPP
 
 #include <lingo/node.hpp>
+#include <lingo/accounting.hpp>
 
+#include <atomic>
+#include <cstdint>
 #include <list>
 #include <set>
 #include <unordered_map>
@@ -61,6 +64,66 @@ struct Singleton_factory
 };
 
 
+// A node factory allocates numbered nodes, giving each an id
+// one greater than that of the last node it created, starting
+// from 0. The nodes of the trees created by a factory therefore
+// have dense ids, which can index side tables. Nodes created by
+// different factories may have the same id, so a program
+// should use one factory for each tree whose ids index a side
+// table (e.g., one for each translated file).
+//
+// Ids are assigned atomically, so nodes may be created by
+// several threads.
+class Node_factory
+{
+public:
+  Node_factory();
+
+  // Create a node of type T, which shall derive from
+  // Numbered_node.
+  template<typename T, typename... Args>
+  T* make(Args&&... args)
+  {
+    static_assert(is_numbered_node<T>(), "T is not a numbered node");
+    T* t = new T(std::forward<Args>(args)...);
+    static_cast<Numbered_node*>(t)->id_ = next_.fetch_add(1, std::memory_order_relaxed);
+    return t;
+  }
+
+  // Returns the number of nodes created.
+  int size() const { return next_.load(std::memory_order_relaxed); }
+
+  // Returns a number that uniquely identifies this factory.
+  std::uint64_t id() const { return id_; }
+
+private:
+  std::uint64_t    id_;
+  std::atomic<int> next_;
+};
+
+
+// A node factory scope makes a factory the current factory of
+// this thread for its lifetime. When the scope ends, the previous
+// factory becomes current again. This allows a language to select
+// the factory for a translation without passing it to every
+// function that makes nodes.
+class Node_factory_scope
+{
+public:
+  explicit Node_factory_scope(Node_factory&);
+  ~Node_factory_scope();
+
+  Node_factory_scope(Node_factory_scope const&) = delete;
+  Node_factory_scope& operator=(Node_factory_scope const&) = delete;
+
+private:
+  Node_factory* prev_;
+};
+
+
+Node_factory* current_node_factory();
+
+
 // -------------------------------------------------------------------------- //
 //                          Garbage collector
 
@@ -69,8 +132,9 @@ class Reach;
 
 
 // Every object allocated through the garbage collector is
-// an instance of the Collectable type.
-struct Collectable
+// an instance of the Collectable type. The memory of these
+// objects is accounted to the garbage collector.
+struct Collectable : Accounted<gc_memory>
 {
   Collectable()
     : marked(false)
@@ -245,7 +309,7 @@ private:
   void sweep();
 
 private:
-  using Object_list = std::list<Collectable*>;
+  using Object_list = std::list<Collectable*, Accounting_allocator<Collectable*, gc_memory>>;
   using Root_set = std::unordered_map<Reach*, Reach*>;
 
   Object_list objects;
@@ -227,12 +227,14 @@ has_end()
 } // namespace traits
 
 
-// Returns true if T is a Nullary_node.
+// Returns true if T is a Nullary_node. Note that k-ary nodes
+// have no member `first`, but are not nullary.
 template<typename T>
 constexpr bool
 is_nullary_node()
 {
-  return !traits::has_first<T>();
+  return !traits::has_first<T>()
+      && !(traits::has_begin<T>() && traits::has_end<T>());
 }
 
 
@@ -277,6 +279,41 @@ is_kary_node()
 
 
 
+// -------------------------------------------------------------------------- //
+//                        Node numbering
+
+class Node_factory;
+
+
+// A numbered node has a dense id, assigned by the node factory
+// that created it (see Node_factory in lingo/memory.hpp). Ids
+// index side tables, which save the results of analyses without
+// hashing (see Side_table in lingo/analysis.hpp). A node that was
+// not created by a factory has id -1.
+struct Numbered_node
+{
+  friend class Node_factory;
+
+  Numbered_node()
+    : id_(-1)
+  { }
+
+  int node_id() const { return id_; }
+
+private:
+  int id_;
+};
+
+
+// Returns true if T is a numbered node.
+template<typename T>
+constexpr bool
+is_numbered_node()
+{
+  return std::is_base_of<Numbered_node, T>::value;
+}
+
+
 // -------------------------------------------------------------------------- //
 //                        Required term
 
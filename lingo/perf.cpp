@@ -0,0 +1,197 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/perf.hpp"
+
+#if HAVE_LINUX_PERF_EVENT_H
+#  include <cstring>
+#  include <linux/perf_event.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+#endif
+
+namespace lingo
+{
+
+char const*
+get_perf_event_name(Perf_event e)
+{
+  switch (e) {
+    case cycles_event: return "cycles";
+    case instructions_event: return "instructions";
+    case branch_misses_event: return "branch-misses";
+    case l1d_misses_event: return "L1-dcache-misses";
+    case llc_misses_event: return "LLC-misses";
+    default: break;
+  }
+  return "<unknown>";
+}
+
+
+Perf_sample
+operator-(Perf_sample const& a, Perf_sample const& b)
+{
+  Perf_sample s;
+  for (int i = 0; i < perf_event_count; ++i)
+    s[i] = a[i] - b[i];
+  return s;
+}
+
+
+Perf_sample&
+operator+=(Perf_sample& a, Perf_sample const& b)
+{
+  for (int i = 0; i < perf_event_count; ++i)
+    a[i] += b[i];
+  return a;
+}
+
+
+#if HAVE_LINUX_PERF_EVENT_H
+
+namespace
+{
+
+// Returns the attributes for counting the event `e`, or
+// false if there is no such event.
+bool
+get_attributes(Perf_event e, perf_event_attr& attr)
+{
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP
+                   | PERF_FORMAT_TOTAL_TIME_ENABLED
+                   | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  // Cache events are encoded as (cache | op << 8 | result << 16).
+  auto cache = [](std::uint64_t c) {
+    return c
+         | PERF_COUNT_HW_CACHE_OP_READ << 8
+         | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+  };
+  switch (e) {
+    case cycles_event:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_CPU_CYCLES;
+      return true;
+    case instructions_event:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+      return true;
+    case branch_misses_event:
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+      return true;
+    case l1d_misses_event:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = cache(PERF_COUNT_HW_CACHE_L1D);
+      return true;
+    case llc_misses_event:
+      attr.type = PERF_TYPE_HW_CACHE;
+      attr.config = cache(PERF_COUNT_HW_CACHE_LL);
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+int
+perf_event_open(perf_event_attr& attr, int group)
+{
+  return syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+
+} // namespace
+
+
+// Open a counter for each event. All counters are in the
+// same group so that they are scheduled together and read
+// with a single system call.
+Perf_counters::Perf_counters()
+  : group_(-1), size_(0)
+{
+  for (int i = 0; i < perf_event_count; ++i) {
+    fds_[i] = -1;
+    index_[i] = -1;
+    perf_event_attr attr;
+    if (!get_attributes(Perf_event(i), attr))
+      continue;
+    int fd = perf_event_open(attr, group_);
+    if (fd < 0)
+      continue;
+    if (group_ < 0)
+      group_ = fd;
+    fds_[i] = fd;
+    index_[i] = size_++;
+  }
+}
+
+
+Perf_counters::~Perf_counters()
+{
+  for (int fd : fds_) {
+    if (fd >= 0)
+      close(fd);
+  }
+}
+
+
+// Returns the current counts. If the counters were not always
+// scheduled on the processor, the counts are scaled by the
+// fraction of time they were running.
+Perf_sample
+Perf_counters::read() const
+{
+  Perf_sample s = {};
+  if (group_ < 0)
+    return s;
+
+  // The group is read as the number of counters, the times
+  // enabled and running, and the value of each counter.
+  std::uint64_t buf[3 + perf_event_count];
+  if (::read(group_, buf, sizeof(buf)) < 0)
+    return s;
+  double scale = 1;
+  if (buf[2] && buf[2] < buf[1])
+    scale = double(buf[1]) / buf[2];
+  for (int i = 0; i < perf_event_count; ++i) {
+    if (index_[i] >= 0)
+      s[i] = buf[3 + index_[i]] * scale;
+  }
+  return s;
+}
+
+
+#else
+
+Perf_counters::Perf_counters()
+  : group_(-1), size_(0)
+{
+  for (int i = 0; i < perf_event_count; ++i) {
+    fds_[i] = -1;
+    index_[i] = -1;
+  }
+}
+
+
+Perf_counters::~Perf_counters()
+{ }
+
+
+Perf_sample
+Perf_counters::read() const
+{
+  return Perf_sample{};
+}
+
+
+#endif
+
+
+} // namespace lingo
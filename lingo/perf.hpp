@@ -0,0 +1,103 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_PERF_HPP
+#define LINGO_PERF_HPP
+
+// The perf module provides access to the hardware performance
+// counters of the processor: cycles, instructions, branch
+// misses, and L1 data and last-level cache misses. These
+// distinguish code that is bound by branch mispredictions from
+// code that is bound by memory.
+//
+// Counters are read through perf_event_open on Linux, and only
+// count events in user mode for the calling thread. Counters are
+// not available on other platforms, or when the system does not
+// permit their use (see /proc/sys/kernel/perf_event_paranoid).
+// In that case, all counts are zero.
+
+#include <cstdint>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Counter samples
+
+// The kinds of counted events.
+enum Perf_event
+{
+  cycles_event,
+  instructions_event,
+  branch_misses_event,
+  l1d_misses_event,
+  llc_misses_event,
+  perf_event_count
+};
+
+
+char const* get_perf_event_name(Perf_event);
+
+
+// A sample of the counters. Subtracting samples gives the
+// number of events in an interval.
+struct Perf_sample
+{
+  std::uint64_t operator[](int n) const { return value[n]; }
+  std::uint64_t& operator[](int n)      { return value[n]; }
+
+  std::uint64_t value[perf_event_count];
+};
+
+
+Perf_sample  operator-(Perf_sample const&, Perf_sample const&);
+Perf_sample& operator+=(Perf_sample&, Perf_sample const&);
+
+
+// -------------------------------------------------------------------------- //
+//                            Counters
+
+// A set of counters for the thread that creates it. Counting
+// starts when the counters are created. Events that are not
+// supported by the processor are not counted.
+class Perf_counters
+{
+public:
+  Perf_counters();
+  ~Perf_counters();
+
+  Perf_counters(Perf_counters const&) = delete;
+  Perf_counters& operator=(Perf_counters const&) = delete;
+
+  bool available() const;
+  bool available(Perf_event) const;
+
+  Perf_sample read() const;
+
+private:
+  int group_;                   // The group leader or -1
+  int fds_[perf_event_count];   // The counter of each event or -1
+  int index_[perf_event_count]; // The position of each event in the group
+  int size_;                    // The number of counters in the group
+};
+
+
+// Returns true if any event is counted.
+inline bool
+Perf_counters::available() const
+{
+  return group_ >= 0;
+}
+
+
+// Returns true if the event `e` is counted.
+inline bool
+Perf_counters::available(Perf_event e) const
+{
+  return fds_[e] >= 0;
+}
+
+
+} // namespace lingo
+
+#endif
@@ -0,0 +1,189 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_PRATT_HPP
+#define LINGO_PRATT_HPP
+
+// The pratt module parses binary expressions by precedence
+// climbing (Pratt, "Top Down Operator Precedence", 1973). The
+// operators of a language are described by a table that maps
+// each token kind to the binding power and associativity of the
+// operator, and to a function that builds its node:
+//
+//    constexpr Operator_table<Expr const*, token_count> binary_ops {
+//      {plus_tok, 10, left_assoc, make_binary<Add>},
+//      {star_tok, 20, left_assoc, make_binary<Mul>},
+//    };
+//
+//    Expr const* e = parse_binary(ts, binary_ops, unary);
+//
+// The table is indexed by token kind, so the operator following
+// an operand is resolved by a single lookup, regardless of the
+// number of operators or precedence levels. Operators bind more
+// tightly when their binding power is greater.
+//
+// The engine works with any stream that provides peek(), get(),
+// position(), and reposition(), including token streams and
+// parse states (see lingo/combinator.hpp). For the latter,
+// precedence() returns a parser that can be used in a rule.
+
+#include <lingo/token.hpp>
+#include <lingo/combinator.hpp>
+
+#include <cstddef>
+#include <initializer_list>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Operator tables
+
+// The associativity of a binary operator.
+enum Associativity
+{
+  left_assoc,
+  right_assoc
+};
+
+
+// A binary operator. Its binding power is 0 if the token is
+// not an operator.
+template<typename T>
+struct Binary_operator
+{
+  int           kind = invalid_tok;
+  int           power = 0;
+  Associativity assoc = left_assoc;
+  T           (*make)(Token, T, T) = nullptr;
+};
+
+
+// A table of binary operators indexed by token kind. Token
+// kinds must be in the range [0, N).
+template<typename T, std::size_t N>
+class Operator_table
+{
+public:
+  constexpr Operator_table(std::initializer_list<Binary_operator<T>>);
+
+  Binary_operator<T> const* find(int) const;
+
+  // Iterators
+  Binary_operator<T> const* begin() const { return ops_; }
+  Binary_operator<T> const* end() const   { return ops_ + N; }
+
+private:
+  Binary_operator<T> ops_[N];
+};
+
+
+template<typename T, std::size_t N>
+constexpr
+Operator_table<T, N>::Operator_table(std::initializer_list<Binary_operator<T>> ops)
+  : ops_()
+{
+  for (Binary_operator<T> const& op : ops)
+    ops_[op.kind] = op;
+}
+
+
+// Returns the operator for the token kind `k`, or null if `k`
+// is not an operator.
+template<typename T, std::size_t N>
+inline Binary_operator<T> const*
+Operator_table<T, N>::find(int k) const
+{
+  if (0 <= k && k < int(N) && ops_[k].power)
+    return &ops_[k];
+  return nullptr;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Parsing
+
+// Record the operators that could have followed an operand.
+// This does nothing except for parse states, where they are
+// reported if parsing fails at that point.
+template<typename S, typename T, std::size_t N>
+inline void
+expected_operators(S&, Operator_table<T, N> const&)
+{ }
+
+
+template<typename T, std::size_t N>
+inline void
+expected_operators(Parse_state& s, Operator_table<T, N> const& ops)
+{
+  for (Binary_operator<T> const& op : ops)
+    if (op.power)
+      s.expected(op.kind);
+}
+
+
+// Parse a binary expression whose operators bind at least as
+// tightly as `min`, calling `operand` to parse the operands.
+// If the operand following an operator cannot be parsed, the
+// stream is repositioned before that operator.
+template<typename S, typename T, std::size_t N, typename P>
+T
+parse_binary(S& s, Operator_table<T, N> const& ops, P const& operand, int min = 1)
+{
+  T e1 = operand(s);
+  if (!e1)
+    return e1;
+  while (true) {
+    Token tok = s.peek();
+    Binary_operator<T> const* op = ops.find(tok.kind());
+    if (!op) {
+      expected_operators(s, ops);
+      break;
+    }
+    if (op->power < min)
+      break;
+
+    auto pos = s.position();
+    s.get();
+    int next = op->assoc == left_assoc ? op->power + 1 : op->power;
+    T e2 = parse_binary(s, ops, operand, next);
+    if (!e2) {
+      s.reposition(pos);
+      break;
+    }
+    e1 = op->make(tok, e1, e2);
+  }
+  return e1;
+}
+
+
+// A parser for binary expressions.
+template<typename P, typename T, std::size_t N>
+struct Precedence_parser
+{
+  using result_type = T;
+
+  T operator()(Parse_state& s) const
+  {
+    return parse_binary(s, *ops, operand);
+  }
+
+  P                           operand;
+  Operator_table<T, N> const* ops;
+};
+
+
+// Returns a parser for binary expressions whose operators are
+// given by the table `ops` and whose operands are parsed by
+// `operand`. The table must outlive the parser.
+template<typename P, typename T, std::size_t N>
+inline Precedence_parser<Parser_type<P>, T, N>
+precedence(P const& operand, Operator_table<T, N> const& ops)
+{
+  return {as_parser(operand), &ops};
+}
+
+
+} // namespace lingo
+
+#endif
@@ -0,0 +1,168 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_RECOVERY_HPP
+#define LINGO_RECOVERY_HPP
+
+// The recovery module supports parsers that recover from syntax
+// errors rather than throwing exceptions. A parsing function
+// that fails diagnoses the error and returns an error node (see
+// make_error_node() in lingo/node.hpp), which its callers test
+// and propagate:
+//
+//    Required<Expr> e = expr();
+//    if (!e || !match(rparen_tok))
+//      return make_error_node<Expr>();
+//
+// At a point where parsing can resume, such as the start of a
+// statement, the parser discards tokens until it reaches one of
+// a set of synchronization tokens (i.e., panic-mode recovery):
+//
+//    constexpr Token_set stmt_sync {semicolon_tok};
+//
+//    Required<Stmt> s = stmt();
+//    if (!s)
+//      recovery_.synchronize(ts_, stmt_sync);
+//
+// Between an error and the next synchronization, further syntax
+// errors are not diagnosed, since they are usually consequences
+// of the first. Parsing continues after synchronization, so a
+// single pass diagnoses errors in each statement.
+
+#include <lingo/token.hpp>
+#include <lingo/error.hpp>
+
+#include <cstdint>
+#include <initializer_list>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Token sets
+
+// A set of token kinds, represented as a bit vector. Token
+// kinds must be in the range [0, 256); other kinds are never
+// members of a set.
+class Token_set
+{
+public:
+  constexpr Token_set();
+  constexpr Token_set(std::initializer_list<int>);
+
+  bool contains(int) const;
+
+  constexpr Token_set operator|(Token_set const&) const;
+
+private:
+  static constexpr int words = 4;
+
+  std::uint64_t bits_[words];
+};
+
+
+constexpr
+Token_set::Token_set()
+  : bits_()
+{ }
+
+
+constexpr
+Token_set::Token_set(std::initializer_list<int> ks)
+  : bits_()
+{
+  for (int k : ks) {
+    if (0 <= k && k < words * 64)
+      bits_[k / 64] |= std::uint64_t(1) << (k % 64);
+  }
+}
+
+
+// Returns true if `k` is in the set.
+inline bool
+Token_set::contains(int k) const
+{
+  if (k < 0 || k >= words * 64)
+    return false;
+  return bits_[k / 64] & (std::uint64_t(1) << (k % 64));
+}
+
+
+// Returns the union of this set and `s`.
+constexpr Token_set
+Token_set::operator|(Token_set const& s) const
+{
+  Token_set r;
+  for (int i = 0; i < words; ++i)
+    r.bits_[i] = bits_[i] | s.bits_[i];
+  return r;
+}
+
+
+// Discard tokens until the next token is in `sync` or the end
+// of input is reached. Returns the number of tokens discarded.
+// The stream can be any that provides eof(), peek(), and get(),
+// including token streams and parse states.
+template<typename S>
+int
+skip_to(S& s, Token_set const& sync)
+{
+  int n = 0;
+  while (!s.eof() && !sync.contains(s.peek().kind())) {
+    s.get();
+    ++n;
+  }
+  return n;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Recovery
+
+// The recovery state of a parser. After a syntax error, the
+// parser is in panic mode until it synchronizes.
+class Recovery
+{
+public:
+  Recovery()
+    : panic_(false)
+  { }
+
+  // Returns true if errors are not being diagnosed.
+  bool panicking() const { return panic_; }
+
+  void error(Location, String const&);
+
+  template<typename S>
+  int synchronize(S&, Token_set const&);
+
+private:
+  bool panic_;
+};
+
+
+// Diagnose a syntax error unless the parser is already in
+// panic mode, and enter panic mode.
+inline void
+Recovery::error(Location loc, String const& msg)
+{
+  if (!panic_)
+    lingo::error(loc, msg);
+  panic_ = true;
+}
+
+
+// Discard tokens up to the next token in `sync` and leave
+// panic mode. Returns the number of tokens discarded.
+template<typename S>
+inline int
+Recovery::synchronize(S& s, Token_set const& sync)
+{
+  panic_ = false;
+  return skip_to(s, sync);
+}
+
+
+} // namespace lingo
+
+#endif
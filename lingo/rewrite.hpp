@@ -0,0 +1,210 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_REWRITE_HPP
+#define LINGO_REWRITE_HPP
+
+// The rewrite module supports passes that transform immutable
+// trees. A rewrite produces a new version of a tree that shares
+// every subtree it does not change with the original. Only the
+// nodes on the path from the root to a change are copied: a node
+// is rebuilt only when one of its children was, and a node whose
+// new children are identical to its old ones is returned as is.
+//
+//    Expr const* step(Rewriter& rw, Expr const* e)
+//    {
+//      ...
+//      return rw.update(e, step(rw, e->first), e->second);
+//    }
+//
+// Copies and new nodes are allocated in an arena, so a version
+// that is no longer needed, along with everything made for it,
+// can be released at once by rolling back the arena (see
+// lingo/arena.hpp). Note that the nodes of later versions may be
+// shared by earlier ones, so versions are released newest first.
+//
+// Nodes are rebuilt through the arity concepts (see lingo/node.hpp).
+// A node is copied, and the copy's `first`, `second`, and `third`
+// members are replaced. Those members shall be assignable. Numbered
+// nodes cannot be rewritten, since a copy would have the same id as
+// the original. Nor can k-ary nodes, whose children are replaced by
+// making a new node.
+
+#include <lingo/arena.hpp>
+#include <lingo/node.hpp>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Rewriters
+
+class Rewriter
+{
+public:
+  explicit Rewriter(Arena& a)
+    : arena_(a), copies_(0), reuses_(0)
+  { }
+
+  template<typename T, typename... Args>
+  T* make(Args&&...);
+
+  template<typename T, typename C1>
+  typename std::enable_if<is_unary_node<T>(), T const*>::type
+  update(T const*, C1 const&);
+
+  template<typename T, typename C1, typename C2>
+  typename std::enable_if<is_binary_node<T>(), T const*>::type
+  update(T const*, C1 const&, C2 const&);
+
+  template<typename T, typename C1, typename C2, typename C3>
+  typename std::enable_if<is_ternary_node<T>(), T const*>::type
+  update(T const*, C1 const&, C2 const&, C3 const&);
+
+  template<typename T, typename F>
+  typename std::enable_if<is_nullary_node<T>(), T const*>::type
+  map(T const*, F);
+
+  template<typename T, typename F>
+  typename std::enable_if<is_unary_node<T>(), T const*>::type
+  map(T const*, F);
+
+  template<typename T, typename F>
+  typename std::enable_if<is_binary_node<T>(), T const*>::type
+  map(T const*, F);
+
+  template<typename T, typename F>
+  typename std::enable_if<is_ternary_node<T>(), T const*>::type
+  map(T const*, F);
+
+  // Returns the arena in which nodes are allocated.
+  Arena& arena() const { return arena_; }
+
+  // Returns the number of nodes copied by updates.
+  std::size_t copies() const { return copies_; }
+
+  // Returns the number of updates that returned the original node.
+  std::size_t reuses() const { return reuses_; }
+
+private:
+  template<typename T>
+  T* copy(T const*);
+
+  Arena&      arena_;
+  std::size_t copies_;
+  std::size_t reuses_;
+};
+
+
+// Allocate a new node of type T in the arena.
+template<typename T, typename... Args>
+inline T*
+Rewriter::make(Args&&... args)
+{
+  return arena_.make<T>(std::forward<Args>(args)...);
+}
+
+
+// Returns a copy of `t` allocated in the arena.
+template<typename T>
+inline T*
+Rewriter::copy(T const* t)
+{
+  static_assert(!is_numbered_node<T>(), "cannot copy numbered nodes");
+  ++copies_;
+  return arena_.make<T>(*t);
+}
+
+
+// Returns `t` if its child is `a`. Otherwise, returns a copy of
+// `t` whose child is `a`.
+template<typename T, typename C1>
+inline typename std::enable_if<is_unary_node<T>(), T const*>::type
+Rewriter::update(T const* t, C1 const& a)
+{
+  if (t->first == a) {
+    ++reuses_;
+    return t;
+  }
+  T* n = copy(t);
+  n->first = a;
+  return n;
+}
+
+
+// Returns `t` if its children are `a` and `b`. Otherwise, returns
+// a copy of `t` with those children.
+template<typename T, typename C1, typename C2>
+inline typename std::enable_if<is_binary_node<T>(), T const*>::type
+Rewriter::update(T const* t, C1 const& a, C2 const& b)
+{
+  if (t->first == a && t->second == b) {
+    ++reuses_;
+    return t;
+  }
+  T* n = copy(t);
+  n->first = a;
+  n->second = b;
+  return n;
+}
+
+
+// Returns `t` if its children are `a`, `b`, and `c`. Otherwise,
+// returns a copy of `t` with those children.
+template<typename T, typename C1, typename C2, typename C3>
+inline typename std::enable_if<is_ternary_node<T>(), T const*>::type
+Rewriter::update(T const* t, C1 const& a, C2 const& b, C3 const& c)
+{
+  if (t->first == a && t->second == b && t->third == c) {
+    ++reuses_;
+    return t;
+  }
+  T* n = copy(t);
+  n->first = a;
+  n->second = b;
+  n->third = c;
+  return n;
+}
+
+
+// Rewrite each child of `t` by `f`, returning `t` if no child
+// changed. A nullary node is returned as is.
+template<typename T, typename F>
+inline typename std::enable_if<is_nullary_node<T>(), T const*>::type
+Rewriter::map(T const* t, F)
+{
+  return t;
+}
+
+
+template<typename T, typename F>
+inline typename std::enable_if<is_unary_node<T>(), T const*>::type
+Rewriter::map(T const* t, F f)
+{
+  return update(t, f(t->first));
+}
+
+
+template<typename T, typename F>
+inline typename std::enable_if<is_binary_node<T>(), T const*>::type
+Rewriter::map(T const* t, F f)
+{
+  return update(t, f(t->first), f(t->second));
+}
+
+
+template<typename T, typename F>
+inline typename std::enable_if<is_ternary_node<T>(), T const*>::type
+Rewriter::map(T const* t, F f)
+{
+  return update(t, f(t->first), f(t->second), f(t->third));
+}
+
+
+} // namespace lingo
+
+#endif
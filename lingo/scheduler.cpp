@@ -0,0 +1,346 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Work deque
+//
+// The memory orderings follow Lê et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models", PPoPP 2013.
+
+Work_deque::Array::Array(std::int64_t n)
+  : size(n), mask(n - 1), data(new std::atomic<Task*>[n])
+{ }
+
+
+Work_deque::Work_deque()
+  : top_(0), bottom_(0)
+{
+  arrays_.emplace_back(new Array(64));
+  array_.store(arrays_.back().get(), std::memory_order_relaxed);
+}
+
+
+Work_deque::~Work_deque()
+{ }
+
+
+// Replace the array `a` with one that is twice as large,
+// copying the tasks in [t, b).
+Work_deque::Array*
+Work_deque::grow(Array* a, std::int64_t t, std::int64_t b)
+{
+  arrays_.emplace_back(new Array(a->size * 2));
+  Array* r = arrays_.back().get();
+  for (std::int64_t i = t; i != b; ++i)
+    r->put(i, a->get(i));
+  array_.store(r, std::memory_order_release);
+  return r;
+}
+
+
+// Push a task onto the bottom of the deque. Only the owner
+// shall push tasks.
+void
+Work_deque::push(Task* t)
+{
+  std::int64_t b = bottom_.load(std::memory_order_relaxed);
+  std::int64_t top = top_.load(std::memory_order_acquire);
+  Array* a = array_.load(std::memory_order_relaxed);
+  if (b - top > a->size - 1)
+    a = grow(a, top, b);
+  a->put(b, t);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(b + 1, std::memory_order_relaxed);
+}
+
+
+// Pop a task from the bottom of the deque, or return null
+// if the deque is empty. Only the owner shall pop tasks.
+Task*
+Work_deque::pop()
+{
+  std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+  Array* a = array_.load(std::memory_order_relaxed);
+  bottom_.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t t = top_.load(std::memory_order_relaxed);
+  if (t > b) {
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  Task* task = a->get(b);
+  if (t == b) {
+    // This is the last task; race thieves for it.
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      task = nullptr;
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+  return task;
+}
+
+
+// Steal a task from the top of the deque, or return null if
+// the deque is empty or another thread took the task.
+Task*
+Work_deque::steal()
+{
+  std::int64_t t = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  std::int64_t b = bottom_.load(std::memory_order_acquire);
+  if (t >= b)
+    return nullptr;
+  Array* a = array_.load(std::memory_order_acquire);
+  Task* task = a->get(t);
+  if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    return nullptr;
+  return task;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Scheduler
+
+namespace
+{
+
+// The scheduler and index of the worker running on this
+// thread, if any.
+struct Worker_id
+{
+  Scheduler const* sched;
+  int              index;
+};
+
+thread_local Worker_id this_worker_ {nullptr, -1};
+
+
+} // namespace
+
+
+Scheduler::Scheduler(int n)
+  : injected_count_(0), epoch_(0), sleepers_(0), stop_(false)
+{
+  for (int i = 0; i < n; ++i)
+    workers_.emplace_back(new Worker());
+  for (int i = 0; i < n; ++i)
+    workers_[i]->thread = std::thread([this, i]() { work(i); });
+}
+
+
+// Stop the workers. All task groups shall have been
+// synchronized.
+Scheduler::~Scheduler()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& w : workers_)
+    w->thread.join();
+}
+
+
+// Returns the index of the calling thread if it is a worker
+// of this scheduler, or -1 otherwise.
+inline int
+Scheduler::current() const
+{
+  return this_worker_.sched == this ? this_worker_.index : -1;
+}
+
+
+// Make a task available for execution. Workers push tasks onto
+// their own deques. Other threads use the shared queue.
+void
+Scheduler::submit(Task* t)
+{
+  int self = current();
+  if (self >= 0) {
+    workers_[self]->deque.push(t);
+  } else {
+    std::lock_guard<std::mutex> lock(mutex_);
+    injected_.push_back(t);
+    injected_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  notify();
+}
+
+
+// Wake a sleeping worker, if any. A worker sleeps only if the
+// epoch has not changed since it last looked for tasks, so
+// incrementing the epoch before testing for sleepers ensures
+// that no wakeup is lost.
+void
+Scheduler::notify()
+{
+  epoch_.fetch_add(1);
+  if (sleepers_.load() > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wake_.notify_one();
+  }
+}
+
+
+// Find a task for the thread `self` (a worker index or -1).
+// Workers first take from their own deque. All threads then
+// take from the shared queue and finally try to steal from
+// each worker in turn.
+Task*
+Scheduler::find(int self)
+{
+  if (self >= 0) {
+    if (Task* t = workers_[self]->deque.pop())
+      return t;
+  }
+  if (injected_count_.load(std::memory_order_relaxed) > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!injected_.empty()) {
+      Task* t = injected_.front();
+      injected_.pop_front();
+      injected_count_.fetch_sub(1, std::memory_order_relaxed);
+      return t;
+    }
+  }
+  int n = workers_.size();
+  int start = self >= 0 ? self + 1 : 0;
+  for (int k = 0; k < n; ++k) {
+    int victim = (start + k) % n;
+    if (victim == self)
+      continue;
+    if (Task* t = workers_[victim]->deque.steal())
+      return t;
+  }
+  return nullptr;
+}
+
+
+// Execute one task, if any can be found. Returns false if
+// there was no task to execute.
+bool
+Scheduler::run_one()
+{
+  if (Task* t = find(current())) {
+    execute(t);
+    return true;
+  }
+  return false;
+}
+
+
+// Run the task, recording any exception in its group.
+void
+Scheduler::execute(Task* t)
+{
+  std::exception_ptr err;
+  try {
+    t->fn();
+  } catch (...) {
+    err = std::current_exception();
+  }
+  Task_group* g = t->group;
+  delete t;
+  g->finish(err);
+}
+
+
+// The main loop of a worker thread. Workers sleep when there
+// are no tasks to execute.
+void
+Scheduler::work(int self)
+{
+  this_worker_ = {this, self};
+  while (true) {
+    std::uint64_t e = epoch_.load();
+    if (Task* t = find(self)) {
+      execute(t);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stop_)
+      return;
+    ++sleepers_;
+    wake_.wait(lock, [this, e]() { return stop_ || epoch_.load() != e; });
+    --sleepers_;
+  }
+}
+
+
+// Returns the global scheduler. It has one worker for each
+// hardware thread except the one used by the caller.
+Scheduler&
+scheduler()
+{
+  static Scheduler sched(std::max<int>(std::thread::hardware_concurrency(), 1) - 1);
+  return sched;
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Task groups
+
+Task_group::~Task_group()
+{
+  join();
+}
+
+
+// Wait for all tasks in the group to complete, then rethrow
+// the first exception thrown by any of them.
+void
+Task_group::sync()
+{
+  join();
+  if (error_) {
+    std::exception_ptr err = error_;
+    error_ = nullptr;
+    std::rethrow_exception(err);
+  }
+}
+
+
+// Execute tasks until the group is complete. The waiting
+// thread helps with any available task, not only those of this
+// group. If no task is available, other threads are running
+// the remaining tasks; back off before trying again.
+void
+Task_group::join()
+{
+  int idle = 0;
+  while (pending_.load(std::memory_order_acquire) != 0) {
+    if (sched_.run_one()) {
+      idle = 0;
+    } else if (++idle < 64) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
+}
+
+
+// Record the completion of a task.
+void
+Task_group::finish(std::exception_ptr err)
+{
+  if (err) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_)
+      error_ = err;
+  }
+  pending_.fetch_sub(1, std::memory_order_release);
+}
+
+
+} // namespace lingo
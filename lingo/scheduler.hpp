@@ -0,0 +1,248 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_SCHEDULER_HPP
+#define LINGO_SCHEDULER_HPP
+
+// The scheduler module runs tasks in parallel on a pool of
+// worker threads. Tasks are spawned into a task group and the
+// group is synchronized to wait for their completion:
+//
+//    int
+//    fib(int n)
+//    {
+//      if (n < 2)
+//        return n;
+//      int a, b;
+//      Task_group g;
+//      g.spawn([&]() { a = fib(n - 1); });
+//      b = fib(n - 2);
+//      g.sync();
+//      return a + b;
+//    }
+//
+// Each worker owns a deque of tasks. Workers push and pop tasks
+// at the bottom of their own deque and, when that is empty,
+// steal tasks from the top of other workers' deques (Chase and
+// Lev, "Dynamic Circular Work-Stealing Deque", 2005). Tasks
+// spawned by threads that are not workers are placed in a
+// shared queue. A thread waiting on a group executes pending
+// tasks until the group is complete, so a scheduler without
+// workers runs every task on the synchronizing thread.
+//
+// Components that need parallelism should share the global
+// scheduler returned by scheduler() rather than creating their
+// own threads.
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lingo
+{
+
+class Scheduler;
+class Task_group;
+
+
+// A task is a unit of work in a task group.
+struct Task
+{
+  std::function<void()> fn;
+  Task_group*           group;
+};
+
+
+// -------------------------------------------------------------------------- //
+//                            Work deque
+
+// A work-stealing deque. The owning thread pushes and pops
+// tasks at the bottom of the deque, and other threads steal
+// tasks from the top. The deque grows as needed. Arrays that
+// are replaced by growth are retained until the deque is
+// destroyed, since thieves may still be reading them.
+class Work_deque
+{
+public:
+  Work_deque();
+  ~Work_deque();
+
+  Work_deque(Work_deque const&) = delete;
+  Work_deque& operator=(Work_deque const&) = delete;
+
+  void  push(Task*);
+  Task* pop();
+  Task* steal();
+
+private:
+  struct Array
+  {
+    explicit Array(std::int64_t);
+
+    Task* get(std::int64_t i) const  { return data[i & mask].load(std::memory_order_relaxed); }
+    void  put(std::int64_t i, Task* t) { data[i & mask].store(t, std::memory_order_relaxed); }
+
+    std::int64_t                        size;
+    std::int64_t                        mask;
+    std::unique_ptr<std::atomic<Task*>[]> data;
+  };
+
+  Array* grow(Array*, std::int64_t, std::int64_t);
+
+  std::atomic<std::int64_t>           top_;
+  std::atomic<std::int64_t>           bottom_;
+  std::atomic<Array*>                 array_;
+  std::vector<std::unique_ptr<Array>> arrays_; // All allocated arrays
+};
+
+
+// -------------------------------------------------------------------------- //
+//                            Scheduler
+
+// A scheduler owns a fixed set of worker threads.
+class Scheduler
+{
+  friend class Task_group;
+
+public:
+  explicit Scheduler(int);
+  ~Scheduler();
+
+  Scheduler(Scheduler const&) = delete;
+  Scheduler& operator=(Scheduler const&) = delete;
+
+  // Returns the number of worker threads.
+  int workers() const { return workers_.size(); }
+
+  // Returns the number of threads that can execute tasks
+  // concurrently, counting the synchronizing thread.
+  int concurrency() const { return workers_.size() + 1; }
+
+private:
+  struct Worker
+  {
+    Work_deque  deque;
+    std::thread thread;
+  };
+
+  void  submit(Task*);
+  void  notify();
+  Task* find(int);
+  bool  run_one();
+  void  execute(Task*);
+  void  work(int);
+  int   current() const;
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::deque<Task*>                    injected_; // Tasks spawned by other threads
+  std::atomic<int>                     injected_count_;
+  std::mutex                           mutex_;
+  std::condition_variable              wake_;
+  std::atomic<std::uint64_t>           epoch_;    // Incremented when tasks are spawned
+  std::atomic<int>                     sleepers_;
+  bool                                 stop_;
+};
+
+
+Scheduler& scheduler();
+
+
+// -------------------------------------------------------------------------- //
+//                            Task groups
+
+// A task group collects spawned tasks so that they can be
+// joined. Tasks may spawn further tasks into their own group.
+// If a task throws an exception, the first such exception is
+// rethrown by sync(). A group must be synchronized before it
+// is destroyed; the destructor waits for remaining tasks but
+// discards their exceptions.
+class Task_group
+{
+  friend class Scheduler;
+
+public:
+  explicit Task_group(Scheduler& s = scheduler())
+    : sched_(s), pending_(0)
+  { }
+
+  ~Task_group();
+
+  Task_group(Task_group const&) = delete;
+  Task_group& operator=(Task_group const&) = delete;
+
+  template<typename F>
+  void spawn(F&&);
+
+  void sync();
+
+private:
+  void join();
+  void finish(std::exception_ptr);
+
+  Scheduler&         sched_;
+  std::atomic<int>   pending_;
+  std::mutex         mutex_;
+  std::exception_ptr error_;
+};
+
+
+// Spawn a task that calls `f`.
+template<typename F>
+inline void
+Task_group::spawn(F&& f)
+{
+  pending_.fetch_add(1, std::memory_order_relaxed);
+  sched_.submit(new Task{std::function<void()>(std::forward<F>(f)), this});
+}
+
+
+// -------------------------------------------------------------------------- //
+//                            Parallel loops
+
+// Call `fn(i)` for each i in [first, last). While the range is
+// larger than `grain`, its upper half is spawned into `g` and the
+// lower half is kept, so the last piece runs inline. The spawned
+// tasks refer to `fn`, which shall outlive the group's join.
+template<typename F>
+void
+parallel_for_range(Task_group& g, std::size_t first, std::size_t last, std::size_t grain, F const& fn)
+{
+  while (last - first > grain) {
+    std::size_t mid = first + (last - first) / 2;
+    g.spawn([&g, mid, last, grain, &fn]() {
+      parallel_for_range(g, mid, last, grain, fn);
+    });
+    last = mid;
+  }
+  for (; first != last; ++first)
+    fn(first);
+}
+
+
+// Call `fn(i)` for each i in [first, last) in parallel. The
+// range is split in halves until pieces contain at most `grain`
+// indexes, so that idle workers steal the largest remaining
+// pieces.
+template<typename F>
+void
+parallel_for(std::size_t first, std::size_t last, F fn, std::size_t grain = 1,
+             Scheduler& s = scheduler())
+{
+  if (first >= last)
+    return;
+  Task_group g(s);
+  parallel_for_range(g, first, last, grain == 0 ? 1 : grain, fn);
+  g.sync();
+}
+
+
+} // namespace lingo
+
+#endif
@@ -5,8 +5,11 @@
 #define LINGO_SYMBOL_HPP
 
 #include <lingo/utility.hpp>
+#include <lingo/accounting.hpp>
 #include <lingo/string.hpp>
 
+#include <atomic>
+#include <mutex>
 #include <unordered_map>
 #include <typeinfo>
 
@@ -30,22 +33,31 @@ struct String_sym;
 // The base class of all symbols of a language. By itself, this
 // class is capable of representing symbols that have no other
 // attributes. Examples include punctuators and operators.
-struct Symbol
+//
+// The memory of symbols is accounted to the symbol table.
+//
+// Each symbol has a small integer id that is unique within its
+// table. Ids are assigned densely, in order of insertion, so they
+// can index vectors of per-symbol information (see Slot_stack in
+// lingo/environment.hpp).
+struct Symbol : Accounted<symbol_memory>
 {
-  friend struct Symbol_table;
+  friend class Symbol_table;
 
   explicit Symbol(int k)
-    : str_(nullptr), tok_(k)
+    : str_(nullptr), tok_(k), id_(-1)
   { }
 
   virtual ~Symbol() { }
 
   String const& spelling() const { return *str_; }
   int           token() const    { return tok_; }
+  int           id() const       { return id_; }
 
 private:
   String const* str_; // The textual representation.
   int           tok_; // The associated token kind.
+  int           id_;  // The id assigned by the symbol table.
 };
 
 
@@ -141,13 +153,38 @@ std::ostream& operator<<(std::ostream&, Symbol const&);
 //                           Symbol table
 
 
+using Symbol_map = std::unordered_map<
+  std::string,
+  Symbol*,
+  std::hash<std::string>,
+  std::equal_to<std::string>,
+  Accounting_allocator<std::pair<std::string const, Symbol*>, symbol_memory>
+>;
+
+
 // The symbol table maintains a mapping of
 // unique string values to their corresponding
 // symbols.
-struct Symbol_table : std::unordered_map<std::string, Symbol*>
+//
+// Symbols may be inserted and looked up concurrently, so that
+// several files can be lexed in parallel. Symbols are never
+// removed, so a symbol remains valid after it is returned. The
+// underlying maps are not exposed, since access to them must be
+// synchronized.
+//
+// The table is divided into shards, each a map with its own
+// lock, and a spelling always belongs to the same shard. Threads
+// that look up different spellings rarely contend for a lock, and
+// a single thread pays for one uncontended lock per operation.
+class Symbol_table
 {
+public:
+  Symbol_table() = default;
   ~Symbol_table();
 
+  Symbol_table(Symbol_table const&) = delete;
+  Symbol_table& operator=(Symbol_table const&) = delete;
+
   template<typename T, typename... Args>
   Symbol* put(int, String const&, Args&&...);
 
@@ -163,15 +200,47 @@ struct Symbol_table : std::unordered_map<std::string, Symbol*>
 
   Symbol const* get(String const&) const;
   Symbol const* get(char const*) const;
+
+  std::size_t size() const;
+
+private:
+  static constexpr int shard_count = 16;
+
+  // Shards are aligned to cache lines so that threads locking
+  // different shards do not share lines.
+  struct alignas(64) Shard
+  {
+    Symbol_map map;
+    std::mutex mutex;
+  };
+
+  Shard& shard(String const&) const;
+
+  mutable Shard    shards_[shard_count];
+  std::atomic<int> count_ {0}; // The number of symbols
 };
 
 
+// Returns the shard holding the spelling `s`. This examines
+// only the length and last character of the spelling, which is
+// cheaper than hashing it again, and varies enough among the
+// identifiers of a program.
+inline auto
+Symbol_table::shard(String const& s) const -> Shard&
+{
+  std::size_t n = s.size();
+  std::size_t h = n ? n * 31 + (unsigned char)s[n - 1] : 0;
+  return shards_[h % shard_count];
+}
+
+
 // Delete allocated resources.
 inline
 Symbol_table::~Symbol_table()
 {
-  for (auto const& x : *this)
-    delete x.second;
+  for (Shard& sh : shards_)
+    for (auto const& x : sh.map)
+      delete x.second;
 }
 
 
@@ -189,12 +258,15 @@ template<typename T, typename... Args>
 Symbol*
 Symbol_table::put(int k, String const& s, Args&&... args)
 {
-  auto x = emplace(s, nullptr);
+  Shard& sh = shard(s);
+  std::lock_guard<std::mutex> lock(sh.mutex);
+  auto x = sh.map.emplace(s, nullptr);
   auto iter = x.first;
   Symbol*& sym = iter->second;
   if (x.second) {
     sym = new T(k, std::forward<Args>(args)...);
     sym->str_ = &iter->first;
+    sym->id_ = count_++;
   } else {
     lingo_assert(is<T>(sym));
   }
@@ -263,8 +335,10 @@ Symbol_table::put_string(int k, String const& s1, String const& s2)
 inline Symbol const*
 Symbol_table::get(String const& s) const
 {
-  auto iter = find(s);
-  if (iter != end())
+  Shard& sh = shard(s);
+  std::lock_guard<std::mutex> lock(sh.mutex);
+  auto iter = sh.map.find(s);
+  if (iter != sh.map.end())
     return iter->second;
   else
     return nullptr;
@@ -276,11 +350,15 @@ Symbol_table::get(String const& s) const
 inline Symbol const*
 Symbol_table::get(char const* s) const
 {
-  auto iter = find(s);
-  if (iter != end())
-    return iter->second;
-  else
-    return nullptr;
+  return get(String(s));
+}
+
+
+// Returns the number of symbols in the table.
+inline std::size_t
+Symbol_table::size() const
+{
+  return count_;
 }
 
 
@@ -6,6 +6,7 @@
 
 #include <lingo/symbol.hpp>
 #include <lingo/location.hpp>
+#include <lingo/accounting.hpp>
 
 #include <list>
 #include <iosfwd>
@@ -174,9 +175,10 @@ std::ostream& operator<<(std::ostream&, Token);
 // TODO: Define appropriate constructors, etc.
 //
 // FIXME: Is this being used?
-struct Tokenbuf : std::list<Token>
+struct Tokenbuf : std::list<Token, Accounting_allocator<Token, token_memory>>
 {
-  using std::list<Token>::list;
+  using Base = std::list<Token, Accounting_allocator<Token, token_memory>>;
+  using Base::Base;
 };
 
 
@@ -0,0 +1,246 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/trace.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lingo
+{
+
+std::atomic<bool> tracing_enabled_(false);
+
+
+namespace
+{
+
+// The number of events retained by each thread.
+constexpr std::size_t buffer_size = 1 << 15;
+
+
+// True when spans record hardware counters.
+std::atomic<bool> counters_enabled_(false);
+
+
+// A ring buffer of the events recorded by a single thread.
+// Only the owning thread writes events. The count of events
+// is published after each write, so that a reader sees only
+// complete events.
+struct Trace_buffer
+{
+  Trace_buffer(int n)
+    : tid(n), count(0), events(buffer_size)
+  { }
+
+  int                        tid;
+  std::atomic<std::uint64_t> count;
+  std::vector<Trace_event>   events;
+};
+
+
+// The buffers of all threads that have recorded events.
+// Buffers are retained after their threads exit so that
+// their events can be written.
+std::mutex                                 buffers_mutex_;
+std::vector<std::unique_ptr<Trace_buffer>> buffers_;
+
+
+// Returns the buffer of the calling thread, creating it on
+// first use. This is the only time a lock is taken when
+// recording events.
+Trace_buffer&
+local_buffer()
+{
+  thread_local Trace_buffer* buf = nullptr;
+  if (!buf) {
+    std::lock_guard<std::mutex> lock(buffers_mutex_);
+    buffers_.emplace_back(new Trace_buffer(buffers_.size() + 1));
+    buf = buffers_.back().get();
+  }
+  return *buf;
+}
+
+
+// Returns the hardware counters of the calling thread,
+// creating them on first use.
+Perf_counters&
+local_counters()
+{
+  thread_local std::unique_ptr<Perf_counters> ctrs(new Perf_counters());
+  return *ctrs;
+}
+
+
+// Write a time in nanoseconds as fractional microseconds.
+void
+write_time(std::ostream& os, std::uint64_t ns)
+{
+  os << ns / 1000 << '.';
+  char frac[4] = {
+    char('0' + ns / 100 % 10), char('0' + ns / 10 % 10), char('0' + ns % 10), 0
+  };
+  os << frac;
+}
+
+
+} // namespace
+
+
+// Returns the current time in nanoseconds, measured from the
+// first use of the trace clock.
+std::uint64_t
+trace_clock()
+{
+  using Clock = std::chrono::steady_clock;
+  static Clock::time_point start = Clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+
+// Enable or disable tracing. Spans that are active when
+// tracing is disabled still record their events.
+void
+enable_tracing(bool b)
+{
+  trace_clock();
+  tracing_enabled_.store(b, std::memory_order_relaxed);
+}
+
+
+// Enable or disable the recording of hardware counters by
+// spans. This has no effect when counters are not available.
+void
+enable_trace_counters(bool b)
+{
+  counters_enabled_.store(b, std::memory_order_relaxed);
+}
+
+
+bool
+are_trace_counters_enabled()
+{
+  return counters_enabled_.load(std::memory_order_relaxed);
+}
+
+
+// Record an event in the calling thread's buffer.
+void
+record_trace_event(Trace_event const& e)
+{
+  Trace_buffer& buf = local_buffer();
+  std::uint64_t n = buf.count.load(std::memory_order_relaxed);
+  buf.events[n % buffer_size] = e;
+  buf.count.store(n + 1, std::memory_order_release);
+}
+
+
+// Begin the span. The counters are read before the clock
+// so that reading them is not included in the interval.
+void
+Trace_span::start(char const* n)
+{
+  name_ = n;
+  if (are_trace_counters_enabled())
+    counts_ = local_counters().read();
+  else
+    counts_ = Perf_sample{};
+  start_ = trace_clock();
+}
+
+
+void
+Trace_span::stop()
+{
+  std::uint64_t end = trace_clock();
+  Perf_sample counts {};
+  if (are_trace_counters_enabled())
+    counts = local_counters().read() - counts_;
+  record_trace_event({name_, start_, end, counts});
+}
+
+
+// Write the recorded events as a Chrome trace. Each event is
+// a complete event ("ph": "X") whose thread id identifies the
+// recording thread. Counts of events that recorded counters
+// are written as arguments of the event. If other threads
+// are recording events, the oldest events in their buffers
+// may be inconsistent.
+void
+write_chrome_trace(std::ostream& os)
+{
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  os << "{\"traceEvents\":[";
+  bool first = true;
+  for (auto const& buf : buffers_) {
+    std::uint64_t n = buf->count.load(std::memory_order_acquire);
+    std::uint64_t i = n > buffer_size ? n - buffer_size : 0;
+    for (; i != n; ++i) {
+      Trace_event const& e = buf->events[i % buffer_size];
+      os << (first ? "\n" : ",\n");
+      os << "{\"name\":\"";
+      for (char const* p = e.name; *p; ++p) {
+        if (*p == '"' || *p == '\\')
+          os << '\\';
+        os << *p;
+      }
+      os << "\",\"cat\":\"lingo\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->tid;
+      os << ",\"ts\":";
+      write_time(os, e.start);
+      os << ",\"dur\":";
+      write_time(os, e.end - e.start);
+      if (e.counts[cycles_event]) {
+        os << ",\"args\":{";
+        for (int k = 0; k < perf_event_count; ++k) {
+          os << (k ? ",\"" : "\"") << get_perf_event_name(Perf_event(k));
+          os << "\":" << e.counts[k];
+        }
+        os << '}';
+      }
+      os << '}';
+      first = false;
+    }
+  }
+  os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+}
+
+
+// Discard all recorded events. Behavior is undefined if
+// other threads are recording events.
+void
+clear_trace()
+{
+  std::lock_guard<std::mutex> lock(buffers_mutex_);
+  for (auto const& buf : buffers_)
+    buf->count.store(0, std::memory_order_relaxed);
+}
+
+
+Trace_file::Trace_file(std::string const& p, bool counters)
+  : path_(p)
+{
+  enable_trace_counters(counters);
+  enable_tracing();
+}
+
+
+// Write the trace. Failure to open the file is reported,
+// but is not an error of the translation.
+Trace_file::~Trace_file()
+{
+  enable_tracing(false);
+  std::ofstream f(path_);
+  if (f)
+    write_chrome_trace(f);
+  else
+    std::cerr << "warning: cannot write trace to '" << path_ << "'\n";
+}
+
+
+} // namespace lingo
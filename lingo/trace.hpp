@@ -0,0 +1,145 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_TRACE_HPP
+#define LINGO_TRACE_HPP
+
+// The trace module records the time spent in the phases of
+// a translation. A span is declared at the start of a region
+// of code and records an event when that region is exited:
+//
+//    void
+//    Parser::operator()()
+//    {
+//      lingo_trace_scope("parse");
+//      ...
+//    }
+//
+// Tracing is disabled by default, in which case declaring a
+// span costs a single load. When enabled, each thread records
+// events into its own fixed-size ring buffer without locking,
+// overwriting its oldest events when the buffer is full. The
+// recorded events can be written in the Chrome trace event
+// format, which is viewed with chrome://tracing or Perfetto.
+//
+// Span names shall be string literals (or otherwise outlive
+// the trace).
+//
+// When trace counters are also enabled, each event records
+// the hardware performance counts (see perf.hpp) of its span.
+// Reading the counters requires a system call at the start
+// and end of each span.
+
+#include <lingo/perf.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace lingo
+{
+
+// -------------------------------------------------------------------------- //
+//                            Trace events
+
+// A trace event records the interval during which a span
+// was active. Times are in nanoseconds from an arbitrary,
+// fixed starting point. The counts are zero unless trace
+// counters were enabled.
+struct Trace_event
+{
+  char const*   name;
+  std::uint64_t start;
+  std::uint64_t end;
+  Perf_sample   counts;
+};
+
+
+std::uint64_t trace_clock();
+
+void enable_tracing(bool = true);
+void enable_trace_counters(bool = true);
+bool are_trace_counters_enabled();
+
+
+// True when tracing is enabled. This is read by every span
+// and shall only be modified through enable_tracing().
+extern std::atomic<bool> tracing_enabled_;
+
+
+// Returns true if tracing is enabled.
+inline bool
+is_tracing_enabled()
+{
+  return tracing_enabled_.load(std::memory_order_relaxed);
+}
+
+
+void record_trace_event(Trace_event const&);
+void write_chrome_trace(std::ostream&);
+void clear_trace();
+
+
+// -------------------------------------------------------------------------- //
+//                            Trace spans
+
+// A trace span records an event covering its lifetime,
+// provided tracing was enabled when it was constructed.
+class Trace_span
+{
+public:
+  explicit Trace_span(char const* n)
+    : name_(nullptr)
+  {
+    if (is_tracing_enabled())
+      start(n);
+  }
+
+  Trace_span(Trace_span const&) = delete;
+  Trace_span& operator=(Trace_span const&) = delete;
+
+  ~Trace_span()
+  {
+    if (name_)
+      stop();
+  }
+
+private:
+  void start(char const*);
+  void stop();
+
+  char const*   name_;
+  std::uint64_t start_;
+  Perf_sample   counts_;
+};
+
+
+// A trace file enables tracing for its lifetime and writes
+// the recorded events to the named file when destroyed. The
+// second argument also enables trace counters.
+class Trace_file
+{
+public:
+  explicit Trace_file(std::string const&, bool = false);
+  ~Trace_file();
+
+  Trace_file(Trace_file const&) = delete;
+  Trace_file& operator=(Trace_file const&) = delete;
+
+private:
+  std::string path_;
+};
+
+
+#define lingo_trace_concat_(a, b) a ## b
+#define lingo_trace_concat(a, b) lingo_trace_concat_(a, b)
+
+// Declare a span covering the rest of the enclosing scope.
+#define lingo_trace_scope(name) \
+  ::lingo::Trace_span lingo_trace_concat(trace_span_, __LINE__)(name)
+
+
+} // namespace lingo
+
+#endif
@@ -0,0 +1,53 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/accounting.hpp"
+#include "lingo/assert.hpp"
+#include "lingo/buffer.hpp"
+#include "lingo/symbol.hpp"
+#include "lingo/token.hpp"
+
+#include <sstream>
+
+using namespace lingo;
+
+int main()
+{
+  std::size_t symbols = get_memory_usage(symbol_memory).current;
+  {
+    Symbol_table syms;
+    syms.put_identifier(1, "x");
+    syms.put_integer(2, "42", 42);
+    lingo_assert(get_memory_usage(symbol_memory).current > symbols);
+  }
+  lingo_assert(get_memory_usage(symbol_memory).current == symbols);
+  lingo_assert(get_memory_usage(symbol_memory).peak > symbols);
+
+  // Building a buffer allocates its line map.
+  std::size_t lines = get_memory_usage(line_memory).allocations;
+  Buffer buf("a\nb\n");
+  lingo_assert(get_memory_usage(line_memory).allocations == lines + 3);
+
+  std::size_t tokens = get_memory_usage(token_memory).current;
+  {
+    Symbol_table syms;
+    Symbol const* sym = syms.put_identifier(1, "a");
+    Token_stream ts(buf);
+    ts.put(Token(Location(&buf, 0), sym));
+    ts.put(Token(Location(&buf, 2), sym));
+    lingo_assert(get_memory_usage(token_memory).current > tokens);
+  }
+  lingo_assert(get_memory_usage(token_memory).current == tokens);
+
+  // Resetting the peaks makes them current.
+  reset_memory_peaks();
+  Memory_usage u = get_memory_usage(symbol_memory);
+  lingo_assert(u.peak == u.current);
+
+  std::stringstream ss;
+  report_memory_usage(ss);
+  lingo_assert(ss.str().find("symbols") != std::string::npos);
+  lingo_assert(ss.str().find("total") != std::string::npos);
+}
@@ -0,0 +1,147 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/analysis.hpp"
+#include "lingo/memory.hpp"
+#include "lingo/assert.hpp"
+
+#include <string>
+
+using namespace lingo;
+
+
+// A binary tree whose leaves have values.
+struct Node
+{
+  Node const* left;
+  Node const* right;
+  int         value;
+};
+
+
+// A numbered binary tree.
+struct Term : Numbered_node
+{
+  Term(Term const* l, Term const* r, int n)
+    : left(l), right(r), value(n)
+  { }
+
+  Term const* left;
+  Term const* right;
+  int         value;
+};
+
+
+int calls = 0;
+
+int sum(Node const*);
+std::string show(Term const*);
+
+
+// Saves the sum of the values in each tree.
+Analysis<Node, int> sums(sum);
+
+
+// Saves the printed form of each term.
+Analysis<Term, std::string> shows(show);
+
+
+int
+sum(Node const* n)
+{
+  ++calls;
+  if (!n->left)
+    return n->value;
+  return sums(n->left) + sums(n->right);
+}
+
+
+std::string
+show(Term const* t)
+{
+  ++calls;
+  if (!t->left)
+    return std::to_string(t->value);
+  return '(' + shows(t->left) + ' ' + shows(t->right) + ')';
+}
+
+
+int main()
+{
+  // The subtree `b` is shared.
+  Node a {nullptr, nullptr, 1};
+  Node b {&a, &a, 0};
+  Node c {&b, &b, 0};
+  Node d {&c, &a, 0};
+
+  // Each node is analyzed once.
+  lingo_assert(sums(&d) == 5);
+  lingo_assert(calls == 4);
+  lingo_assert(sums.size() == 4);
+  lingo_assert(sums(&c) == 4);
+  lingo_assert(calls == 4);
+  lingo_assert(sums.stats().misses == 4);
+  lingo_assert(sums.stats().hits == 4);
+
+  // Erased results are recomputed.
+  lingo_assert(sums.find(&b) && *sums.find(&b) == 2);
+  sums.erase(&b);
+  lingo_assert(!sums.find(&b));
+  lingo_assert(sums(&b) == 2);
+  lingo_assert(calls == 5);
+
+  sums.clear();
+  lingo_assert(sums.size() == 0);
+  lingo_assert(sums(&d) == 5);
+  lingo_assert(calls == 9);
+
+  // Factories number nodes densely.
+  Node_factory f;
+  Term const* t1 = f.make<Term>(nullptr, nullptr, 1);
+  Term const* t2 = f.make<Term>(nullptr, nullptr, 2);
+  Term const* t3 = f.make<Term>(t1, t2, 0);
+  Term const* t4 = f.make<Term>(t3, t3, 0);
+  lingo_assert(t1->node_id() == 0 && t4->node_id() == 3);
+  lingo_assert(f.size() == 4);
+
+  // Factory scopes select the current factory of the thread,
+  // and restore the previous one when they end.
+  lingo_assert(!current_node_factory());
+  {
+    Node_factory_scope s1(f);
+    {
+      Node_factory g;
+      Node_factory_scope s2(g);
+      lingo_assert(current_node_factory() == &g);
+    }
+    lingo_assert(current_node_factory() == &f);
+  }
+  lingo_assert(!current_node_factory());
+
+  // Side tables hold values for ids across several pages, and
+  // references to values are not invalidated as they grow.
+  Side_table<int> tab;
+  lingo_assert(!tab.find(0) && !tab.find(1000));
+  int& v = tab.put(1, 10);
+  tab.put(1000, 20);
+  lingo_assert(&v == tab.find(1) && v == 10);
+  lingo_assert(tab.find(1000) && *tab.find(1000) == 20);
+  lingo_assert(!tab.find(2) && !tab.find(999));
+  lingo_assert(tab.size() == 2);
+  tab[2] += 5;
+  lingo_assert(*tab.find(2) == 5 && tab.size() == 3);
+  tab.erase(1);
+  lingo_assert(!tab.find(1) && tab.size() == 2);
+  tab.clear();
+  lingo_assert(!tab.find(2) && tab.size() == 0);
+
+  // The analysis of numbered nodes uses a side table.
+  calls = 0;
+  lingo_assert(shows(t4) == "((1 2) (1 2))");
+  lingo_assert(calls == 4);
+  lingo_assert(shows(t3) == "(1 2)");
+  lingo_assert(calls == 4);
+  lingo_assert(shows.size() == 4);
+}
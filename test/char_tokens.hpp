@@ -0,0 +1,43 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#ifndef LINGO_TEST_CHAR_TOKENS_HPP
+#define LINGO_TEST_CHAR_TOKENS_HPP
+
+// The tests of parsing facilities use small languages whose
+// tokens are single characters, so that the text of a test is
+// tokenized without a lexer.
+
+#include "lingo/buffer.hpp"
+#include "lingo/symbol.hpp"
+#include "lingo/token.hpp"
+
+namespace lingo
+{
+
+// A token stream over `text`, in which each character is a
+// token. The token of kind k is spelled by the kth character of
+// `kinds`, so a test declares its token kinds in that order.
+struct Char_tokens
+{
+  Char_tokens(char const* kinds, String const& text)
+    : buf(text), ts(buf)
+  {
+    for (int k = 0; kinds[k]; ++k)
+      symbols.put_symbol(k, String(1, kinds[k]));
+    for (std::size_t i = 0; i < text.size(); ++i)
+      ts.put(Token(Location(&buf, i), symbols.get(String(1, text[i]))));
+  }
+
+  Char_tokens(Char_tokens const&) = delete;
+  Char_tokens& operator=(Char_tokens const&) = delete;
+
+  Symbol_table symbols;
+  Buffer       buf;
+  Token_stream ts;
+};
+
+
+} // namespace lingo
+
+#endif
@@ -0,0 +1,231 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/checkpoint.hpp"
+#include "lingo/token.hpp"
+#include "lingo/node.hpp"
+#include "lingo/assert.hpp"
+
+#include "char_tokens.hpp"
+
+#include <string>
+
+using namespace lingo;
+
+
+// The token kinds, spelled by the characters of `kinds`.
+enum Token_kind
+{
+  a_tok,
+  lparen_tok,
+  rparen_tok,
+};
+
+
+char const* kinds = "a()";
+
+
+struct Node
+{
+  Node(char k, Node const* l, Node const* r)
+    : kind(k), left(l), right(r)
+  { }
+
+  char        kind;
+  Node const* left;
+  Node const* right;
+};
+
+
+// A parser for the ambiguous language
+//
+//    expr: 'a'
+//          '(' expr ')'
+//          '(' 'a' ')' expr
+//
+// which tries the last alternative (a cast) first.
+struct Parser
+{
+  Node const* expr()
+  {
+    if (ts.peek().kind() == a_tok) {
+      ts.get();
+      return arena.make<Node>('a', nullptr, nullptr);
+    }
+    if (ts.peek().kind() == lparen_tok) {
+      Checkpoint<Token_stream> cp(ts, arena);
+      if (Required<Node> e = cast()) {
+        cp.commit();
+        return *e;
+      }
+      cp.rollback();
+      return paren();
+    }
+    error(ts.location(), "expected expression");
+    return make_error_node<Node>();
+  }
+
+  Node const* cast()
+  {
+    ts.get();
+    Node const* t = arena.make<Node>('t', nullptr, nullptr);
+    if (ts.peek().kind() != a_tok || ts.peek(1).kind() != rparen_tok) {
+      error(ts.location(), "expected type");
+      return make_error_node<Node>();
+    }
+    ts.get();
+    ts.get();
+    Required<Node> e = expr();
+    if (!e)
+      return make_error_node<Node>();
+    return arena.make<Node>('c', t, *e);
+  }
+
+  Node const* paren()
+  {
+    ts.get();
+    Required<Node> e = expr();
+    if (!e)
+      return make_error_node<Node>();
+    if (ts.peek().kind() != rparen_tok) {
+      error(ts.location(), "expected ')'");
+      return make_error_node<Node>();
+    }
+    ts.get();
+    return *e;
+  }
+
+  Token_stream& ts;
+  Arena&        arena;
+};
+
+
+// Returns the node kinds of `n` in prefix order.
+std::string
+to_string(Node const* n)
+{
+  if (!n)
+    return "";
+  return n->kind + to_string(n->left) + to_string(n->right);
+}
+
+
+// Parse `str`, returning the prefix form of the expression and
+// storing the number of errors in `errs`.
+std::string
+parse(String const& str, int& errs)
+{
+  Char_tokens in(kinds, str);
+  Diagnostic_context diags(true);
+  Arena arena;
+  Parser p{in.ts, arena};
+  Node const* n = p.expr();
+  errs = error_count();
+  lingo_assert(diags.diagnostics().size() == std::size_t(errs));
+  if (!is_valid_node(n))
+    return "<error>";
+  lingo_assert(in.ts.eof());
+  return to_string(n);
+}
+
+
+int main()
+{
+  // Arenas align allocations and reuse the blocks released by
+  // a rollback.
+  {
+    std::size_t mem = get_memory_usage(arena_memory).current;
+    {
+      Arena a(256);
+      lingo_assert(a.size() == 0 && a.capacity() == 0);
+      char* c = (char*)a.allocate(1, 1);
+      double* d = a.make<double>(1.5);
+      lingo_assert((char*)d > c && *d == 1.5);
+      lingo_assert(reinterpret_cast<std::uintptr_t>(d) % alignof(double) == 0);
+
+      Arena::Watermark w = a.watermark();
+      std::size_t n = a.size();
+      for (int i = 0; i < 100; ++i)
+        a.allocate(100);
+      std::size_t cap = a.capacity();
+      lingo_assert(cap >= 100 * 100);
+      lingo_assert(get_memory_usage(arena_memory).current == mem + cap);
+
+      a.rollback(w);
+      lingo_assert(a.size() == n);
+      lingo_assert(a.make<double>(2.5) == d + 1);
+      for (int i = 0; i < 100; ++i)
+        a.allocate(100);
+      lingo_assert(a.capacity() == cap);
+
+      // Allocations larger than a block get their own block.
+      a.allocate(1000);
+      lingo_assert(a.capacity() > cap);
+    }
+    lingo_assert(get_memory_usage(arena_memory).current == mem);
+  }
+
+  // Rolling back discards the diagnostics emitted since the
+  // mark, and committing keeps them.
+  {
+    Diagnostic_context diags(true);
+    error(Location(), "first");
+    Diagnostic_mark m1 = mark_diagnostics();
+    error(Location(), "second");
+    Diagnostic_mark m2 = mark_diagnostics();
+    warning(Location(), "third");
+    error(Location(), "fourth");
+    lingo_assert(diags.speculating());
+    lingo_assert(error_count() == 3);
+    rollback_diagnostics(m2);
+    lingo_assert(error_count() == 2);
+    lingo_assert(diags.diagnostics().size() == 2);
+    commit_diagnostics(m1);
+    lingo_assert(!diags.speculating());
+    lingo_assert(diags.diagnostics().size() == 2);
+    lingo_assert(diags.diagnostics()[1].msg == "second");
+  }
+
+  // A context that does not suppress diagnostics saves them
+  // while speculating.
+  {
+    Diagnostic_context diags;
+    Diagnostic_mark m = mark_diagnostics();
+    error(Location(), "speculative");
+    lingo_assert(diags.diagnostics().size() == 1);
+    rollback_diagnostics(m);
+    lingo_assert(diags.diagnostics().empty());
+    lingo_assert(diags.ok());
+  }
+
+  // Checkpoints restore the stream position when rolled back,
+  // including when they are destroyed.
+  {
+    Char_tokens in(kinds, "(a)");
+    Token_stream& ts = in.ts;
+    Diagnostic_context diags(true);
+    {
+      Checkpoint<Token_stream> cp(ts);
+      ts.get();
+      error(ts.location(), "speculative");
+    }
+    lingo_assert(ts.peek().kind() == lparen_tok);
+    lingo_assert(error_count() == 0);
+    Checkpoint<Token_stream> cp(ts);
+    ts.get();
+    cp.commit();
+    lingo_assert(!cp.active());
+    lingo_assert(ts.peek().kind() == a_tok);
+  }
+
+  // Abandoned alternatives leave no diagnostics.
+  int errs;
+  lingo_assert(parse("a", errs) == "a" && errs == 0);
+  lingo_assert(parse("(a)a", errs) == "cta" && errs == 0);
+  lingo_assert(parse("(a)", errs) == "a" && errs == 0);
+  lingo_assert(parse("((a))", errs) == "a" && errs == 0);
+  lingo_assert(parse("(a)(a)a", errs) == "ctcta" && errs == 0);
+  lingo_assert(parse("(a", errs) == "<error>" && errs == 1);
+}
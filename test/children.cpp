@@ -0,0 +1,143 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/children.hpp"
+#include "lingo/debug.hpp"
+#include "lingo/assert.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace lingo;
+
+
+struct Node
+{
+  virtual ~Node() { }
+};
+
+
+struct Leaf : Node
+{
+};
+
+
+// A k-ary node whose children follow it in memory.
+struct List : Node
+{
+  template<typename R>
+  List(int n, R const& r)
+    : tag(n), kids(r)
+  { }
+
+  Child_array<Node const*>::iterator begin() const { return kids.begin(); }
+  Child_array<Node const*>::iterator end() const   { return kids.end(); }
+
+  int                      tag;
+  Child_array<Node const*> kids;
+};
+
+
+// A k-ary node whose child array is not its last member.
+struct Bad_list : Node
+{
+  template<typename R>
+  Bad_list(int n, R const& r)
+    : kids(r), tag(n)
+  { }
+
+  Child_array<Node const*>::iterator begin() const { return kids.begin(); }
+  Child_array<Node const*>::iterator end() const   { return kids.end(); }
+
+  Child_array<Node const*> kids;
+  int                      tag;
+};
+
+
+// A k-ary node whose children are in a vector.
+struct Vector_list : Node
+{
+  std::vector<Node const*>::const_iterator begin() const { return kids.begin(); }
+  std::vector<Node const*>::const_iterator end() const   { return kids.end(); }
+
+  std::vector<Node const*> kids;
+};
+
+
+inline String get_node_name(Leaf const*)        { return "Leaf"; }
+inline String get_node_name(List const*)        { return "List"; }
+inline String get_node_name(Vector_list const*) { return "List"; }
+
+
+void
+debug(Printer& p, Node const* n)
+{
+  if (Leaf const* l = dynamic_cast<Leaf const*>(n))
+    debug(p, l);
+  else if (List const* l = dynamic_cast<List const*>(n))
+    debug(p, l);
+  else
+    debug(p, static_cast<Vector_list const*>(n));
+}
+
+
+template<typename T>
+String
+debug_string(T const& x)
+{
+  std::stringstream ss;
+  Printer p(ss);
+  debug(p, x);
+  return ss.str();
+}
+
+
+int main()
+{
+  static_assert(is_kary_node<List>(), "");
+  static_assert(is_kary_node<Child_array<Node const*>>(), "");
+  static_assert(std::is_same<Child_type<List>, Node const*>(), "");
+
+  Arena a;
+  Arena::Watermark w = a.watermark();
+  Leaf l1, l2;
+
+  // The node and its children are allocated together.
+  std::vector<Node const*> v {&l1, &l2, &l1};
+  List* x = make_kary<List>(a, v, 1);
+  lingo_assert(a.size() == kary_size<List>(3));
+  lingo_assert(kary_size<List>(3) == sizeof(List) + 3 * sizeof(Node const*));
+  lingo_assert(x->tag == 1 && x->kids.size() == 3);
+  lingo_assert(x->kids[0] == &l1 && x->kids[1] == &l2 && x->kids[2] == &l1);
+  lingo_assert((char const*)x->end() <= (char const*)x + kary_size<List>(3));
+
+  // Nodes may have no children, and be nested.
+  List* y = make_kary<List>(a, {}, 2);
+  List* z = make_kary<List>(a, {x, &l2, y}, 3);
+  lingo_assert(y->kids.empty() && z->kids.size() == 3);
+  lingo_assert(x->kids.size() == 3 && x->kids[1] == &l2);
+
+  // Child arrays print as vectors do.
+  Vector_list vx;
+  vx.kids = v;
+  lingo_assert(debug_string(x) == "(List (Leaf) (Leaf) (Leaf))");
+  lingo_assert(debug_string(x) == debug_string(&vx));
+  lingo_assert(debug_string(z) == "(List (List (Leaf) (Leaf) (Leaf)) (Leaf) (List ))");
+
+  // Members after the child array are detected.
+  bool caught = false;
+  try {
+    make_kary<Bad_list>(a, {&l1}, 4);
+  }
+  catch (std::runtime_error const&) {
+    caught = true;
+  }
+  lingo_assert(caught);
+
+  // Rolling back the arena releases the nodes.
+  a.rollback(w);
+  lingo_assert(a.size() == 0);
+}
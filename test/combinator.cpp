@@ -0,0 +1,109 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/combinator.hpp"
+#include "lingo/assert.hpp"
+
+#include "char_tokens.hpp"
+
+#include <string>
+
+using namespace lingo;
+
+
+// The token kinds, spelled by the characters of `kinds`.
+enum Token_kind
+{
+  lparen_tok,
+  rparen_tok,
+  a_tok,
+  x_tok,
+  y_tok,
+};
+
+
+char const* kinds = "()axy";
+
+
+char const*
+spelling(int k)
+{
+  static char const* spell[] {"(", ")", "a", "x", "y"};
+  return spell[k];
+}
+
+
+// A parser that counts the number of times that it is applied
+// to the end of an input.
+struct Counter
+{
+  int operator()(Token) const { return ++count; }
+
+  int& count;
+};
+
+
+// Parse the grammar
+//
+//    s ::= n 'x' | n 'y'
+//    n ::= '(' n ')' 'x' | '(' n ')' 'y' | 'a'
+//
+// Without memoization, this requires time exponential in the
+// nesting depth of the input.
+int
+parse(String const& str, bool memo, int& count)
+{
+  Char_tokens in(kinds, str);
+  Counter a {count};
+  auto first = [](int n, Token) { return n; };
+  auto nest = [](Token, int n, Token, Token) { return n; };
+
+  Rule<int> s;
+  Rule<int> n("nested");
+  s = alt(sequence(first, n, tok(x_tok)), sequence(first, n, tok(y_tok)));
+  n = alt(sequence(nest, tok(lparen_tok), n, tok(rparen_tok), tok(x_tok)),
+          sequence(nest, tok(lparen_tok), n, tok(rparen_tok), tok(y_tok)),
+          sequence(a, tok(a_tok)));
+
+  Parse_state state(in.ts, spelling, memo);
+  int r = s(state);
+  if (r && state.eof())
+    state.commit();
+  else
+    state.diagnose();
+  lingo_assert(!r || in.ts.eof());
+  return r;
+}
+
+
+int main()
+{
+  int depth = 12;
+  String str = String(depth, '(') + "a";
+  for (int i = 0; i < depth; ++i)
+    str += ")y";
+  str += "y";
+
+  // Memoization applies each rule once per position.
+  int memo = 0;
+  lingo_assert(parse(str, true, memo) == 1);
+  lingo_assert(memo == 1);
+
+  // Backtracking re-parses nested inputs.
+  int plain = 0;
+  lingo_assert(parse(str, false, plain) == plain);
+  lingo_assert(plain == 1 << (depth + 1));
+
+  // Errors are diagnosed at the furthest failure.
+  {
+    Diagnostic_context diags(true);
+    int count = 0;
+    lingo_assert(parse("((a)x)a", true, count) == 0);
+    lingo_assert(diags.errors() == 1);
+    Diagnostic const& d = diags.diagnostics()[0];
+    lingo_assert(d.msg == "expected 'x' or 'y' but got 'a'");
+    lingo_assert(d.info.data.loc.offset() == 6);
+  }
+}
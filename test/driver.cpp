@@ -0,0 +1,72 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/driver.hpp"
+#include "lingo/assert.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace lingo;
+
+
+// Returns the length of the file's text, diagnosing an error
+// if the text contains a '!'.
+std::size_t
+translate(File& f)
+{
+  std::size_t n = f.str().find('!');
+  if (n != std::string::npos)
+    error(Location(&f, n), String("unexpected '!'"));
+  return f.str().size();
+}
+
+
+int main()
+{
+  Path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  boost::filesystem::create_directory(dir);
+
+  std::vector<std::string> paths;
+  for (int i = 0; i < 32; ++i) {
+    Path p = dir / std::to_string(i);
+    std::ofstream f(p.native());
+    f << std::string(i, 'a') << (i % 8 == 3 ? "!" : "") << '\n';
+    paths.push_back(p.native());
+  }
+  paths.push_back((dir / "missing").native());
+  paths.push_back(paths[0]);
+
+  Scheduler sched(3);
+  Diagnostic_context diags(true);
+  std::vector<File_result<std::size_t>> files = process_files(paths, translate, sched);
+  lingo_assert(files.size() == paths.size());
+
+  // Results are in the order of the paths.
+  for (int i = 0; i < 32; ++i) {
+    lingo_assert(files[i].path == paths[i]);
+    lingo_assert(files[i].file != nullptr);
+    lingo_assert(files[i].result == std::size_t(i + 1 + (i % 8 == 3)));
+    lingo_assert(files[i].errors == (i % 8 == 3));
+  }
+
+  // Missing files are errors.
+  lingo_assert(files[32].file == nullptr);
+  lingo_assert(files[32].errors == 1);
+
+  // Files are opened once.
+  lingo_assert(files[33].file == files[0].file);
+
+  // Diagnostics are reported in the order of the paths.
+  lingo_assert(report_diagnostics(files) == 5);
+  lingo_assert(diags.errors() == 5);
+  auto const& list = diags.diagnostics();
+  lingo_assert(list.size() == 5);
+  for (int i = 0; i < 4; ++i)
+    lingo_assert(list[i].info.data.loc.file() == files[i * 8 + 3].file);
+
+  boost::filesystem::remove_all(dir);
+}
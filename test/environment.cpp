@@ -0,0 +1,89 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/environment.hpp"
+#include "lingo/symbol.hpp"
+#include "lingo/assert.hpp"
+
+#include <cstdlib>
+#include <string>
+
+using namespace lingo;
+
+
+using Name_map = Environment<Symbol const*, int>;
+using Name_stack = Stack<Name_map>;
+using Slots = Slot_stack<int>;
+
+
+// Returns the value bound to `sym`, or -1 if it is unbound.
+template<typename S>
+int
+value(S const& s, Symbol const* sym)
+{
+  auto const* b = s.lookup(sym);
+  return b ? b->second : -1;
+}
+
+
+int main()
+{
+  Symbol_table syms;
+  Symbol const* x = syms.put_identifier(1, "x");
+  Symbol const* y = syms.put_identifier(1, "y");
+  Symbol const* z = syms.put_identifier(1, "z");
+
+  // Symbols have dense ids.
+  lingo_assert(x->id() == 0 && y->id() == 1 && z->id() == 2);
+  lingo_assert(syms.put_identifier(1, "x")->id() == 0);
+
+  // Inner bindings shadow outer ones until their scope is
+  // popped.
+  Slots s;
+  s.push();
+  s.bind(x, 1);
+  lingo_assert(value(s, x) == 1 && value(s, y) == -1);
+  s.push();
+  s.bind(x, 2);
+  s.bind(y, 3);
+  lingo_assert(value(s, x) == 2 && value(s, y) == 3);
+  lingo_assert(s.lookup(x)->scope == 1);
+  lingo_assert(s.lookup(x)->shadowed->second == 1);
+  s.rebind(y, 4);
+  lingo_assert(value(s, y) == 4);
+  s.pop();
+  lingo_assert(s.size() == 1);
+  lingo_assert(value(s, x) == 1 && value(s, y) == -1);
+  lingo_assert(s.lookup(x)->scope == 0);
+  s.pop();
+  lingo_assert(s.empty() && value(s, x) == -1);
+
+  // A slot stack resolves names as a stack of environments
+  // does.
+  Symbol const* names[] = {x, y, z};
+  std::srand(42);
+  Name_stack env;
+  env.push();
+  s.push();
+  for (int i = 0; i < 1000; ++i) {
+    int r = std::rand() % 4;
+    if (r == 0 && env.size() > 1) {
+      env.pop();
+      s.pop();
+    } else if (r == 1) {
+      env.push();
+      s.push();
+    } else {
+      Symbol const* sym = names[std::rand() % 3];
+      if (!env.top().lookup(sym)) {
+        env.bind(sym, i);
+        s.bind(sym, i);
+      }
+    }
+    lingo_assert(env.size() == s.size());
+    for (Symbol const* sym : names)
+      lingo_assert(value(env, sym) == value(s, sym));
+  }
+}
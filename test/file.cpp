@@ -0,0 +1,74 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/file.hpp"
+#include "lingo/assert.hpp"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace lingo;
+
+
+int main()
+{
+  Path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  boost::filesystem::create_directory(dir);
+
+  std::vector<Path> paths;
+  for (int i = 0; i < 16; ++i) {
+    Path p = dir / std::to_string(i);
+    std::ofstream f(p.native());
+    f << i << '\n';
+    paths.push_back(p);
+  }
+
+  File_manager fm;
+
+  // Asynchronous and synchronous opens yield the same file.
+  std::shared_future<File&> f1 = fm.open_async(paths[0]);
+  std::shared_future<File&> f2 = fm.open_async(paths[0]);
+  File& f3 = fm.open(paths[0]);
+  lingo_assert(&f1.get() == &f3);
+  lingo_assert(&f2.get() == &f3);
+  lingo_assert(&fm.open_async(paths[0]).get() == &f3);
+  lingo_assert(f3.str() == "0\n");
+
+  // Errors are reported by the future.
+  std::shared_future<File&> f4 = fm.open_async(dir / "missing");
+  try {
+    f4.get();
+    lingo_unreachable("File_manager::open_async() unexpectedly succeeded.");
+  }
+  catch (boost::filesystem::filesystem_error const&) { }
+
+  // Files are prefetched in order.
+  for (int n : {0, 1, 4, 32}) {
+    File_prefetcher files(paths, n, fm);
+    for (int i = 0; i < 16; ++i) {
+      lingo_assert(!files.done());
+      File& f = files.next();
+      lingo_assert(f.str() == std::to_string(i) + "\n");
+      lingo_assert(&f == &fm.open(paths[i]));
+    }
+    lingo_assert(files.done());
+  }
+
+  // A manager may be destroyed while files are being loaded.
+  // Abandoned loads report a broken promise.
+  for (int i = 0; i < 50; ++i) {
+    std::vector<std::shared_future<File&>> loads;
+    {
+      File_manager tmp;
+      for (Path const& p : paths)
+        loads.push_back(tmp.open_async(p));
+    }
+    for (std::shared_future<File&> const& f : loads)
+      f.wait();
+  }
+
+  boost::filesystem::remove_all(dir);
+}
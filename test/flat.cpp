@@ -0,0 +1,133 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/flat.hpp"
+#include "lingo/debug.hpp"
+#include "lingo/assert.hpp"
+
+#include <sstream>
+#include <vector>
+
+using namespace lingo;
+
+
+// Linked nodes of each arity.
+struct Leaf
+{
+};
+
+
+struct Node;
+
+
+struct Add
+{
+  Add(Node const* l, Node const* r)
+    : first(l), second(r)
+  { }
+
+  Node const* first;
+  Node const* second;
+};
+
+
+struct List
+{
+  using Vec = std::vector<Node const*>;
+
+  Vec::const_iterator begin() const { return kids.begin(); }
+  Vec::const_iterator end() const   { return kids.end(); }
+
+  Vec kids;
+};
+
+
+// A linked node is one of the nodes above.
+struct Node
+{
+  Leaf const* leaf;
+  Add const*  add;
+  List const* list;
+};
+
+
+inline String get_node_name(Leaf const*) { return "Leaf"; }
+inline String get_node_name(Add const*)  { return "Add"; }
+inline String get_node_name(List const*) { return "List"; }
+
+
+void
+debug(Printer& p, Node const* n)
+{
+  if (n->leaf)
+    debug(p, n->leaf);
+  else if (n->add)
+    debug(p, n->add);
+  else
+    debug(p, n->list);
+}
+
+
+enum Kind
+{
+  leaf_kind,
+  add_kind,
+  list_kind,
+};
+
+
+template<typename T>
+String
+debug_string(T const& x)
+{
+  std::stringstream ss;
+  Printer p(ss);
+  debug(p, x);
+  return ss.str();
+}
+
+
+int main()
+{
+  Location loc;
+
+  // Build (List (Add (Leaf) (Leaf)) (Leaf) (List (Leaf))) in both
+  // layouts.
+  Flat_tree t({"Leaf", "Add", "List"});
+  int a = t.make(leaf_kind, loc);
+  int b = t.make(leaf_kind, loc);
+  int c = t.make(add_kind, loc, {a, b});
+  int d = t.make(list_kind, loc, {b});
+  int e = t.make(list_kind, loc, {c, a, d});
+
+  lingo_assert(t.size() == 5);
+  lingo_assert(t.kind(c) == add_kind && t.arity(c) == 2);
+  lingo_assert(t.child(c, 0) == a && t.child(c, 1) == b);
+  lingo_assert(t.arity(d) == 1);
+  lingo_assert(t.arity(e) == 3 && t.end(e) - t.begin(e) == 3);
+  lingo_assert(t.kinds()[e] == list_kind);
+  lingo_assert(t.name(t[e].kind()) == "List");
+
+  Leaf leaf;
+  Node n1 {&leaf, nullptr, nullptr};
+  Add add {&n1, &n1};
+  Node n2 {nullptr, &add, nullptr};
+  List single {{&n1}};
+  Node n3 {nullptr, nullptr, &single};
+  List list {{&n2, &n1, &n3}};
+  Node n4 {nullptr, nullptr, &list};
+
+  // The flat tree prints as the linked tree does.
+  String s = debug_string(&n4);
+  lingo_assert(s == "(List (Add (Leaf) (Leaf)) (Leaf) (List (Leaf)))");
+  lingo_assert(debug_string(t[e]) == s);
+
+  // The views satisfy the arity concepts.
+  static_assert(is_nullary_node<Flat_nullary>(), "");
+  static_assert(is_unary_node<Flat_unary>(), "");
+  static_assert(is_binary_node<Flat_binary>(), "");
+  static_assert(is_kary_node<Flat_kary>(), "");
+  static_assert(!is_nullary_node<Flat_kary>(), "");
+}
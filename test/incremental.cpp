@@ -0,0 +1,140 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/incremental.hpp"
+#include "lingo/symbol.hpp"
+#include "lingo/assert.hpp"
+
+#include <cctype>
+#include <string>
+
+using namespace lingo;
+
+
+enum Token_kind
+{
+  semicolon_tok,
+  identifier_tok,
+};
+
+
+Symbol_table symbols;
+
+
+// Scan the next token. Identifiers are sequences of letters,
+// and other characters except spaces are semicolons.
+Token
+scan(Character_stream& cs)
+{
+  while (!cs.eof() && std::isspace(cs.peek()))
+    cs.get();
+  if (cs.eof())
+    return Token();
+  Location loc = cs.location();
+  String str(1, cs.get());
+  if (!std::isalpha(str[0]))
+    return Token(loc, symbols.get(";"));
+  while (!cs.eof() && std::isalpha(cs.peek()))
+    str += cs.get();
+  return Token(loc, symbols.put_identifier(identifier_tok, str));
+}
+
+
+// Returns the tokens of `ts` as a string, each followed by the
+// offset at which it begins.
+std::string
+to_string(Token_stream& ts)
+{
+  std::string str;
+  for (Token const& tok : ts.buf_)
+    str += tok.spelling() + '@' + std::to_string(tok.location().offset()) + ' ';
+  return str;
+}
+
+
+// Returns the tokens of the text in `buf`, lexed from scratch.
+std::string
+lex(Buffer const& buf)
+{
+  Buffer copy(buf.str());
+  Token_stream ts(copy);
+  Character_stream cs(copy);
+  while (Token tok = scan(cs))
+    ts.put(tok);
+  return to_string(ts);
+}
+
+
+// Apply the edit to `text` and check that relexing produces
+// the same tokens as lexing the edited text. Returns the
+// damaged region.
+Damage
+check(String const& text, Text_edit const& e)
+{
+  Buffer buf(text);
+  Token_stream ts(buf);
+  Character_stream cs(buf);
+  while (Token tok = scan(cs))
+    ts.put(tok);
+
+  Damage d = relex(buf, ts, e, scan);
+  lingo_assert(to_string(ts) == lex(buf));
+  lingo_assert(ts.position() == ts.buf_.begin());
+  return d;
+}
+
+
+int main()
+{
+  symbols.put_symbol(semicolon_tok, ";");
+
+  // Only the edited token is relexed.
+  Damage d = check("ab cd; ef", {3, 2, "xyz"});
+  lingo_assert(d.first == 3 && d.old_last == 5 && d.new_last == 6);
+
+  // Edits that join and split tokens.
+  d = check("ab cd; ef", {2, 1, ""});
+  lingo_assert(d.first == 0 && d.old_last == 5 && d.new_last == 4);
+  d = check("abcd; ef", {2, 0, " "});
+  lingo_assert(d.first == 0 && d.old_last == 4 && d.new_last == 5);
+
+  // Edits at the beginning and end of the text, and edits of
+  // the whole text.
+  check("ab cd", {0, 0, "x"});
+  check("ab cd", {5, 0, " x"});
+  check("ab cd", {0, 5, ""});
+  check("", {0, 0, "ab; cd"});
+  check("ab; cd", {2, 0, "x;y"});
+
+  // An edit within spaces relexes nothing but moves the tokens
+  // that follow.
+  d = check("ab   cd", {3, 0, "  "});
+  lingo_assert(d.first == 3 && d.old_last == 5 && d.new_last == 7);
+
+  // Entries that overlap damage are removed and those that
+  // follow are moved.
+  Reuse_table<int> t;
+  Token_stream::Position p;
+  t.save({0, 2, p, 1});
+  t.save({3, 5, p, 2});
+  t.save({6, 8, p, 3});
+  t.commit();
+  lingo_assert(t.size() == 3);
+  lingo_assert(t.find(3) && t.find(3)->value == 2);
+  lingo_assert(!t.find(1));
+
+  t.damage({3, 4, 7});
+  lingo_assert(t.size() == 2);
+  lingo_assert(t.find(0) && t.find(0)->value == 1);
+  lingo_assert(!t.find(3) && !t.find(6));
+  lingo_assert(t.find(9) && t.find(9)->value == 3);
+
+  // Entries that end where damage begins are kept.
+  t.damage({2, 2, 2});
+  lingo_assert(t.size() == 2);
+
+  t.commit();
+  lingo_assert(t.size() == 0);
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/pratt.hpp"
+#include "lingo/assert.hpp"
+
+#include "char_tokens.hpp"
+
+#include <string>
+
+using namespace lingo;
+
+
+// The token kinds, spelled by the characters of `kinds`.
+enum Token_kind
+{
+  a_tok,
+  plus_tok,
+  star_tok,
+  caret_tok,
+  token_count
+};
+
+
+char const* kinds = "a+*^";
+
+
+// A node is the parenthesized text of the expression.
+using Node = std::string const*;
+
+
+template<char C>
+Node
+make(Token, Node e1, Node e2)
+{
+  return new std::string('(' + *e1 + C + *e2 + ')');
+}
+
+
+constexpr Operator_table<Node, token_count> ops {
+  {plus_tok,  10, left_assoc,  make<'+'>},
+  {star_tok,  20, left_assoc,  make<'*'>},
+  {caret_tok, 30, right_assoc, make<'^'>},
+};
+
+
+// Parse the expression in `str`. If tokens remain, the result
+// ends with an ellipsis.
+std::string
+parse(String const& str)
+{
+  Char_tokens in(kinds, str);
+  auto operand = [](Token_stream& ts) -> Node {
+    if (ts.peek().kind() == a_tok)
+      return new std::string(ts.get().spelling());
+    return nullptr;
+  };
+  Node e = parse_binary(in.ts, ops, operand);
+  if (!e)
+    return "";
+  if (!in.ts.eof())
+    return *e + " ...";
+  return *e;
+}
+
+
+int main()
+{
+  lingo_assert(parse("a") == "a");
+  lingo_assert(parse("a+a+a") == "((a+a)+a)");
+  lingo_assert(parse("a+a*a") == "(a+(a*a))");
+  lingo_assert(parse("a*a+a") == "((a*a)+a)");
+  lingo_assert(parse("a^a^a") == "(a^(a^a))");
+  lingo_assert(parse("a+a*a^a^a*a+a") == "((a+((a*(a^(a^a)))*a))+a)");
+
+  // An operator without a right operand is not consumed.
+  lingo_assert(parse("a+a+") == "(a+a) ...");
+  lingo_assert(parse("+") == "");
+}
@@ -0,0 +1,151 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/recovery.hpp"
+#include "lingo/node.hpp"
+#include "lingo/assert.hpp"
+
+#include "char_tokens.hpp"
+
+#include <string>
+
+using namespace lingo;
+
+
+// The token kinds, spelled by the characters of `kinds`.
+enum Token_kind
+{
+  a_tok,
+  lparen_tok,
+  rparen_tok,
+  semicolon_tok,
+};
+
+
+char const* kinds = "a();";
+
+
+constexpr Token_set stmt_sync {semicolon_tok};
+constexpr Token_set paren_sync = stmt_sync | Token_set {rparen_tok};
+
+
+using Node = std::string const*;
+
+
+// A parser for the language
+//
+//    stmt: expr [;]
+//    expr: 'a'
+//          '(' expr ')'
+//
+// that recovers from errors by skipping to the next statement.
+struct Parser
+{
+  Node expr()
+  {
+    if (ts.peek().kind() == a_tok)
+      return new std::string(ts.get().spelling());
+    if (ts.peek().kind() == lparen_tok) {
+      ts.get();
+      Required<std::string> e = expr();
+      if (!e)
+        return make_error_node<std::string>();
+      if (ts.peek().kind() != rparen_tok) {
+        recovery.error(ts.location(), "expected ')'");
+        return make_error_node<std::string>();
+      }
+      ts.get();
+      return *e;
+    }
+    recovery.error(ts.location(), "expected expression");
+    return make_error_node<std::string>();
+  }
+
+  // Returns the number of well-formed statements.
+  int stmts()
+  {
+    int n = 0;
+    while (!ts.eof()) {
+      if (Required<std::string> e = expr())
+        ++n;
+      else
+        recovery.synchronize(ts, stmt_sync);
+      if (ts.peek().kind() == semicolon_tok)
+        ts.get();
+    }
+    return n;
+  }
+
+  Token_stream& ts;
+  Recovery      recovery;
+};
+
+
+// Parse `str`, returning the number of well-formed statements
+// and storing the number of errors in `errs`.
+int
+parse(String const& str, int& errs)
+{
+  Char_tokens in(kinds, str);
+  Diagnostic_context diags(true);
+  Parser p{in.ts, Recovery()};
+  int n = p.stmts();
+  errs = error_count();
+  return n;
+}
+
+
+int main()
+{
+  // Token sets.
+  lingo_assert(stmt_sync.contains(semicolon_tok));
+  lingo_assert(!stmt_sync.contains(rparen_tok));
+  lingo_assert(paren_sync.contains(rparen_tok));
+  lingo_assert(paren_sync.contains(semicolon_tok));
+  lingo_assert(!paren_sync.contains(a_tok));
+  lingo_assert(!paren_sync.contains(invalid_tok));
+  lingo_assert(!Token_set {1000}.contains(1000));
+  lingo_assert(Token_set {200}.contains(200));
+
+  // Skipping stops before a synchronization token, or at the
+  // end of input.
+  {
+    Char_tokens in(kinds, "aa(;a");
+    Token_stream& ts = in.ts;
+    lingo_assert(skip_to(ts, stmt_sync) == 3);
+    lingo_assert(ts.peek().kind() == semicolon_tok);
+    lingo_assert(skip_to(ts, stmt_sync) == 0);
+    ts.get();
+    lingo_assert(skip_to(ts, stmt_sync) == 1);
+    lingo_assert(ts.eof());
+  }
+
+  // Each ill-formed statement is diagnosed once, and parsing
+  // continues with the next statement.
+  int errs;
+  lingo_assert(parse("a;(a);a", errs) == 3 && errs == 0);
+  lingo_assert(parse("(a;a", errs) == 1 && errs == 1);
+  lingo_assert(parse("((;a;)", errs) == 1 && errs == 2);
+  lingo_assert(parse(";;", errs) == 0 && errs == 2);
+
+  // Errors following the first in a statement are not
+  // diagnosed.
+  {
+    Char_tokens in(kinds, "(");
+    Token_stream& ts = in.ts;
+    Diagnostic_context diags(true);
+    Recovery r;
+    lingo_assert(!r.panicking());
+    r.error(ts.location(), "first");
+    r.error(ts.location(), "second");
+    lingo_assert(r.panicking());
+    lingo_assert(error_count() == 1);
+    r.synchronize(ts, stmt_sync);
+    lingo_assert(!r.panicking());
+    lingo_assert(ts.eof());
+    r.error(ts.location(), "third");
+    lingo_assert(error_count() == 2);
+  }
+}
@@ -0,0 +1,129 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/rewrite.hpp"
+#include "lingo/assert.hpp"
+
+using namespace lingo;
+
+
+struct Expr
+{
+  virtual ~Expr() { }
+};
+
+
+struct Int : Expr
+{
+  Int(int n)
+    : value(n)
+  { }
+
+  int value;
+};
+
+
+struct Neg : Expr
+{
+  Neg(Expr const* e)
+    : first(e)
+  { }
+
+  Expr const* first;
+};
+
+
+struct Add : Expr
+{
+  Add(Expr const* l, Expr const* r)
+    : first(l), second(r)
+  { }
+
+  Expr const* first;
+  Expr const* second;
+};
+
+
+struct If : Expr
+{
+  If(Expr const* c, Expr const* t, Expr const* f)
+    : first(c), second(t), third(f)
+  { }
+
+  Expr const* first;
+  Expr const* second;
+  Expr const* third;
+};
+
+
+// Replace each occurrence of `x` in `e` by the integer `n`.
+Expr const*
+replace(Rewriter& rw, Expr const* e, Expr const* x, int n)
+{
+  if (e == x)
+    return rw.make<Int>(n);
+  auto f = [&](Expr const* c) { return replace(rw, c, x, n); };
+  if (Int const* t = dynamic_cast<Int const*>(e))
+    return rw.map(t, f);
+  if (Neg const* t = dynamic_cast<Neg const*>(e))
+    return rw.map(t, f);
+  if (Add const* t = dynamic_cast<Add const*>(e))
+    return rw.map(t, f);
+  return rw.map(static_cast<If const*>(e), f);
+}
+
+
+int main()
+{
+  Arena a;
+  Rewriter rw(a);
+
+  // -(1 + 2) + (if 3 then 4 else 5)
+  Int i1(1), i2(2), i3(3), i4(4), i5(5);
+  Add a1(&i1, &i2);
+  Neg n1(&a1);
+  If c1(&i3, &i4, &i5);
+  Add root(&n1, &c1);
+
+  // Identical children yield the original node.
+  lingo_assert(rw.update(&a1, &i1, &i2) == &a1);
+  lingo_assert(rw.update(&n1, &a1) == &n1);
+  lingo_assert(rw.update(&c1, &i3, &i4, &i5) == &c1);
+  lingo_assert(rw.copies() == 0 && rw.reuses() == 3);
+
+  // Different children yield a copy.
+  Add const* a2 = rw.update(&a1, &i2, &i1);
+  lingo_assert(a2 != &a1 && a2->first == &i2 && a2->second == &i1);
+  lingo_assert(a1.first == &i1 && a1.second == &i2);
+  lingo_assert(rw.copies() == 1);
+
+  // Only the nodes on the path to a change are copied. The
+  // other subtrees are shared with the original.
+  std::size_t before = a.size();
+  Arena::Watermark w = a.watermark();
+  Expr const* e = replace(rw, &root, &i2, 7);
+  Add const* r = dynamic_cast<Add const*>(e);
+  lingo_assert(r && r != &root);
+  lingo_assert(r->second == &c1);
+  Neg const* n2 = dynamic_cast<Neg const*>(r->first);
+  lingo_assert(n2 && n2 != &n1);
+  Add const* a3 = dynamic_cast<Add const*>(n2->first);
+  lingo_assert(a3 && a3 != &a1 && a3->first == &i1);
+  lingo_assert(dynamic_cast<Int const*>(a3->second)->value == 7);
+  lingo_assert(rw.copies() == 4);
+
+  // The original tree is unchanged.
+  lingo_assert(root.first == &n1 && n1.first == &a1 && a1.second == &i2);
+
+  // A rewrite that changes nothing copies nothing.
+  Int other(0);
+  lingo_assert(replace(rw, &root, &other, 7) == &root);
+  lingo_assert(rw.copies() == 4);
+
+  // Abandoned versions are released with the arena.
+  lingo_assert(a.size() > before);
+  a.rollback(w);
+  lingo_assert(rw.arena().size() == before);
+}
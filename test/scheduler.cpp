@@ -0,0 +1,86 @@
+// Copyright (c) 2015 Andrew Sutton
+// All rights reserved
+
+#include "config.hpp"
+
+#include "lingo/scheduler.hpp"
+#include "lingo/assert.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace lingo;
+
+
+int
+fib(Scheduler& s, int n)
+{
+  if (n < 2)
+    return n;
+  int a, b;
+  Task_group g(s);
+  g.spawn([&]() { a = fib(s, n - 1); });
+  b = fib(s, n - 2);
+  g.sync();
+  return a + b;
+}
+
+
+void
+test_deque()
+{
+  Work_deque d;
+  std::vector<Task> tasks(200);
+  for (Task& t : tasks)
+    d.push(&t);
+  lingo_assert(d.steal() == &tasks[0]);
+  lingo_assert(d.pop() == &tasks[199]);
+  for (int i = 198; i > 0; --i)
+    lingo_assert(d.pop() == &tasks[i]);
+  lingo_assert(d.pop() == nullptr);
+  lingo_assert(d.steal() == nullptr);
+}
+
+
+void
+test_scheduler(int workers)
+{
+  Scheduler s(workers);
+  lingo_assert(fib(s, 20) == 6765);
+
+  std::vector<int> v(10000);
+  parallel_for(0, v.size(), [&](std::size_t i) { v[i] = i; }, 16, s);
+  for (std::size_t i = 0; i < v.size(); ++i)
+    lingo_assert(v[i] == int(i));
+
+  // Tasks may spawn tasks into their own group.
+  std::atomic<int> n(0);
+  Task_group g(s);
+  for (int i = 0; i < 100; ++i) {
+    g.spawn([&]() {
+      g.spawn([&]() { ++n; });
+      ++n;
+    });
+  }
+  g.sync();
+  lingo_assert(n == 200);
+
+  // Exceptions are rethrown by sync.
+  Task_group h(s);
+  h.spawn([]() { throw std::runtime_error("task"); });
+  try {
+    h.sync();
+    lingo_unreachable("Task_group::sync() unexpectedly succeeded.");
+  }
+  catch (std::runtime_error const&) {}
+}
+
+
+int main()
+{
+  test_deque();
+  test_scheduler(0);
+  test_scheduler(3);
+  lingo_assert(fib(scheduler(), 10) == 55);
+}